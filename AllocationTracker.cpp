@@ -0,0 +1,62 @@
+#include "AllocationTracker.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Keeps the returned pointer aligned for any type
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    std::atomic<std::uint64_t> allocationCount{0};
+    std::atomic<std::uint64_t> allocatedBytes{0};
+    std::atomic<std::int64_t> liveBytes{0};
+    std::atomic<std::int64_t> peakBytes{0};
+
+    void* trackedAllocate(std::size_t size) {
+        char* block = static_cast<char*>(std::malloc(size + HEADER));
+        if(!block) throw std::bad_alloc();
+        *reinterpret_cast<std::size_t*>(block) = size;
+
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        std::int64_t live = liveBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) + static_cast<std::int64_t>(size);
+        std::int64_t peak = peakBytes.load(std::memory_order_relaxed);
+        while(live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        return block + HEADER;
+    }
+
+    void trackedFree(void* pointer) {
+        if(!pointer) return;
+        char* block = static_cast<char*>(pointer) - HEADER;
+        liveBytes.fetch_sub(static_cast<std::int64_t>(*reinterpret_cast<std::size_t*>(block)), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void* operator new(std::size_t size) { return trackedAllocate(size); }
+void* operator new[](std::size_t size) { return trackedAllocate(size); }
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { trackedFree(pointer); }
+
+std::uint64_t AllocationTracker::getAllocationCount() {
+    return allocationCount.load();
+}
+
+std::uint64_t AllocationTracker::getAllocatedBytes() {
+    return allocatedBytes.load();
+}
+
+std::int64_t AllocationTracker::getLiveBytes() {
+    return liveBytes.load();
+}
+
+std::int64_t AllocationTracker::getPeakBytes() {
+    return peakBytes.load();
+}
+
+void AllocationTracker::resetPeak() {
+    peakBytes.store(liveBytes.load());
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+// Heap accounting for the headless tools.
+// AllocationTracker.cpp replaces the global operator new and delete, so it is only linked into
+// tools that measure memory (bench, stresstest), never into the game.
+// Every allocation carries its size in a small header, which lets frees be counted exactly.
+class AllocationTracker {
+public:
+    // Allocations made since start
+    static std::uint64_t getAllocationCount();
+    // Bytes requested by those allocations
+    static std::uint64_t getAllocatedBytes();
+    // Bytes allocated and not freed yet
+    static std::int64_t getLiveBytes();
+    // Most live bytes since start or the last resetPeak()
+    static std::int64_t getPeakBytes();
+    // Start following the peak again from the current live bytes
+    static void resetPeak();
+
+    // Hide constructors to prevent instantiation
+    AllocationTracker() = delete;
+    ~AllocationTracker() = delete;
+};
@@ -9,127 +9,185 @@ int Pathfinder::getHeuristic(const sf::Vector2i& posA, const sf::Vector2i& posB)
 }
 
 // 檢查節點是否可走
-bool Pathfinder::isWalkable(const sf::Vector2i& pos, const std::vector<std::vector<char>>& tileMap) const {
-    int rows = static_cast<int>(tileMap.size());
-    int cols = static_cast<int>(tileMap[0].size());
-    
-    // 檢查邊界
-    if (pos.y < 0 || pos.y >= rows || pos.x < 0 || pos.x >= cols) {
-        return false;
-    }
-    
-    char tile = tileMap[pos.y][pos.x];
-    // 只有 'X' (牆壁) 和 'D' (發射器) 不可走
+bool Pathfinder::isWalkable(int index, const TileGrid& tileMap) const {
+    // 地圖外的格子屬於牆壁外框，不需另外檢查邊界
+    // 只有牆壁與發射器的圖層不可走
     // TraceMonster (M) 可以重疊通過
-    return tile != 'X' && tile != 'D';
+    return !tileMap.hasAny(TileGrid::BLOCKING, index);
+}
+
+// 依網格尺寸調整陣列，並遞增世代使上一次搜尋的資料失效
+void Pathfinder::prepare(const TileGrid& tileMap) {
+    int newRows = tileMap.getRow();
+    int newCols = tileMap.getColumn();
+
+    if (newRows != rows || newCols != cols) {
+        rows = newRows;
+        cols = newCols;
+        stride = tileMap.getStride();
+        size_t count = tileMap.getCellCount();
+        stamp.assign(count, 0);
+        gCost.resize(count);
+        fCost.resize(count);
+        parent.resize(count);
+        heapIndex.resize(count);
+        openHeap.reserve(count);
+        path.reserve(count);
+        generation = 0;
+    }
+
+    // 世代溢位時才需要真正清空戳記
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    openHeap.clear();
 }
 
-// 清理在堆上創建的節點
-void Pathfinder::cleanupNodes(std::unordered_map<sf::Vector2i, PathNode*>& allNodes) {
-    for (auto const& [pos, node] : allNodes) {
-        delete node;
+// 從終點沿父節點索引回溯，直接由後往前填入路徑
+void Pathfinder::reconstructPath(int endIndex) {
+    path.resize(gCost[endIndex] + 1);
+    int current = endIndex;
+    for (int i = static_cast<int>(path.size()) - 1; i >= 0; i--) {
+        path[i] = {current % stride - 1, current / stride - 1};
+        current = parent[current];
     }
-    allNodes.clear();
 }
 
-// 從終點向起點回溯路徑
-std::vector<sf::Vector2i> Pathfinder::reconstructPath(PathNode* endNode) {
-    std::vector<sf::Vector2i> path;
-    PathNode* current = endNode;
-    while (current) {
-        path.push_back(current->pos);
-        current = current->parent;
+// F 成本低的優先；F 成本相同時，H 成本 (F - G) 低的優先
+bool Pathfinder::heapLess(int a, int b) const {
+    if (fCost[a] != fCost[b]) {
+        return fCost[a] < fCost[b];
     }
-    // 反轉路徑，使其從起點開始
-    std::reverse(path.begin(), path.end());
-    
-    // A* 路徑包含起點和終點。如果路徑只有一個點（起點），代表已到達終點。
-    return path;
+    return fCost[a] - gCost[a] < fCost[b] - gCost[b];
+}
+
+void Pathfinder::siftUp(int position) {
+    int node = openHeap[position];
+    while (position > 0) {
+        int parentPosition = (position - 1) / 2;
+        int parentNode = openHeap[parentPosition];
+        if (!heapLess(node, parentNode)) break;
+        openHeap[position] = parentNode;
+        heapIndex[parentNode] = position;
+        position = parentPosition;
+    }
+    openHeap[position] = node;
+    heapIndex[node] = position;
+}
+
+void Pathfinder::siftDown(int position) {
+    int size = static_cast<int>(openHeap.size());
+    int node = openHeap[position];
+    while (true) {
+        int child = position * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heapLess(openHeap[child + 1], openHeap[child])) {
+            child++;
+        }
+        if (!heapLess(openHeap[child], node)) break;
+        openHeap[position] = openHeap[child];
+        heapIndex[openHeap[position]] = position;
+        position = child;
+    }
+    openHeap[position] = node;
+    heapIndex[node] = position;
+}
+
+void Pathfinder::heapPush(int node) {
+    openHeap.push_back(node);
+    siftUp(static_cast<int>(openHeap.size()) - 1);
+}
+
+int Pathfinder::heapPop() {
+    int top = openHeap.front();
+    int last = openHeap.back();
+    openHeap.pop_back();
+    if (!openHeap.empty()) {
+        openHeap[0] = last;
+        siftDown(0);
+    }
+    heapIndex[top] = -1; // 標記為已關閉
+    return top;
 }
 
 // A* 尋路核心函數
-std::vector<sf::Vector2i> Pathfinder::findPath(
-    const sf::Vector2i& start, 
-    const sf::Vector2i& goal, 
-    const std::vector<std::vector<char>>& tileMap) 
+const std::vector<sf::Vector2i>& Pathfinder::findPath(
+    const sf::Vector2i& start,
+    const sf::Vector2i& goal,
+    const TileGrid& tileMap)
 {
+    path.clear();
+
     // 如果起點就是終點，直接返回
     if (start == goal) {
-        return {start};
+        path.push_back(start);
+        return path;
+    }
+
+    prepare(tileMap);
+    if (!tileMap.contains(start) || !tileMap.contains(goal)) {
+        return path;
     }
-    
-    // 儲存待檢查節點 (使用 priority_queue 來高效獲取最低 F 成本節點)
-    std::priority_queue<PathNode, std::vector<PathNode>, std::less<PathNode>> openList;
-    
-    // 儲存所有已創建的節點，用於記錄成本和檢查 Closed List
-    // key: 節點座標, value: 指向該節點的裸指針
-    std::unordered_map<sf::Vector2i, PathNode*> allNodes;
-
-    // 創建起始節點
-    PathNode* startNode = new PathNode;
-    startNode->pos = start;
-    startNode->gCost = 0;
-    startNode->hCost = getHeuristic(start, goal);
-    startNode->parent = nullptr;
-
-    openList.push(*startNode);
-    allNodes[start] = startNode;
-    
-    // 循環直到找到目標或 openList 為空
-    while (!openList.empty()) {
-        
-        // 1. 獲取 openList 中 F 成本最低的節點
-        PathNode current = openList.top();
-        openList.pop();
-
-        PathNode* currentPtr = allNodes[current.pos];
-        
+
+    // 加入起始節點
+    int startIndex = tileMap.index(start);
+    int goalIndex = tileMap.index(goal);
+    stamp[startIndex] = generation;
+    gCost[startIndex] = 0;
+    fCost[startIndex] = getHeuristic(start, goal);
+    parent[startIndex] = -1;
+    heapPush(startIndex);
+
+    // 循環直到找到目標或 open list 為空
+    while (!openHeap.empty()) {
+
+        // 1. 取出 F 成本最低的節點
+        int current = heapPop();
+
         // 🎯 檢查是否到達終點
-        if (current.pos == goal) {
-            std::vector<sf::Vector2i> path = reconstructPath(currentPtr);
-            cleanupNodes(allNodes);
+        if (current == goalIndex) {
+            reconstructPath(current);
             return path;
         }
 
-        // 2. 遍歷鄰居
-        for (const auto& offset : NEIGHBORS) {
-            sf::Vector2i neighborPos = current.pos + offset;
-            
+        sf::Vector2i currentPos = tileMap.position(current);
+        // 計算從起點經由 current 到鄰居的 G 成本 (移動一步成本為 1)
+        int newGCost = gCost[current] + 1;
+
+        // 2. 遍歷鄰居 (索引加上預先算好的位移即可)
+        const std::array<int, 4>& offsets = tileMap.getNeighborOffsets();
+        for (int i = 0; i < TileGrid::NEIGHBOR_COUNT; i++) {
+            int neighbor = current + offsets[i];
+
             // 檢查是否可走
-            if (!isWalkable(neighborPos, tileMap)) {
+            if (!isWalkable(neighbor, tileMap)) {
                 continue;
             }
 
-            // 計算從起點經由 current 到 neighbor 的 G 成本
-            int newGCost = currentPtr->gCost + 1; // 假設移動一步成本為 1
-
-            // 檢查該節點是否已存在於 allNodes
-            if (allNodes.find(neighborPos) == allNodes.end()) {
-                // 節點不存在：這是新節點，創建它並加入 openList
-                PathNode* neighborNode = new PathNode;
-                neighborNode->pos = neighborPos;
-                neighborNode->parent = currentPtr;
-                neighborNode->gCost = newGCost;
-                neighborNode->hCost = getHeuristic(neighborPos, goal);
-                
-                allNodes[neighborPos] = neighborNode;
-                openList.push(*neighborNode); // 將副本推入優先級佇列
-            } 
-            else {
-                // 節點已存在：檢查是否找到更短的路徑 (更低的 G 成本)
-                PathNode* existingNode = allNodes[neighborPos];
-                if (newGCost < existingNode->gCost) {
-                    // 找到更短的路徑：更新成本和父節點
-                    existingNode->gCost = newGCost;
-                    existingNode->parent = currentPtr;
-                    // 重新將其推入優先級佇列 (或更新現有的，這裡採用推入副本的簡單策略)
-                    openList.push(*existingNode);
+            sf::Vector2i neighborPos = {currentPos.x + TileGrid::NEIGHBOR_DX[i], currentPos.y + TileGrid::NEIGHBOR_DY[i]};
+            if (stamp[neighbor] != generation) {
+                // 本世代第一次遇到：初始化並加入 open list
+                stamp[neighbor] = generation;
+                gCost[neighbor] = newGCost;
+                fCost[neighbor] = newGCost + getHeuristic(neighborPos, goal);
+                parent[neighbor] = current;
+                heapPush(neighbor);
+            }
+            else if (newGCost < gCost[neighbor]) {
+                // 找到更短的路徑：更新成本與父節點，並在堆積中就地調整 (decrease-key)
+                fCost[neighbor] -= gCost[neighbor] - newGCost;
+                gCost[neighbor] = newGCost;
+                parent[neighbor] = current;
+                if (heapIndex[neighbor] >= 0) {
+                    siftUp(heapIndex[neighbor]);
+                } else {
+                    heapPush(neighbor);
                 }
             }
         }
     }
 
     // 找不到路徑
-    cleanupNodes(allNodes);
-    return {}; 
-}
\ No newline at end of file
+    return path;
+}
@@ -0,0 +1,297 @@
+// Microbenchmarks of the game logic.
+// Times pathfinding, turn advance, reset, stage parsing and pattern expansion on generated
+// fixtures, and counts heap allocations per operation through AllocationTracker.
+// Results are printed as a table and can be written as JSON to diff between releases.
+//
+// Usage: bench [--filter TEXT] [--min-time SECONDS] [--json FILE]
+#include "Types.hpp"
+#include "Pattern.hpp"
+#include "TileGrid.hpp"
+#include "Astar.hpp"
+#include "Simulation.hpp"
+#include "StageParser.hpp"
+#include "StageGenerator.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// One operation of a benchmark; the fixture is built once before timing starts
+using Operation = std::function<void()>;
+
+struct Benchmark {
+    std::string name;
+    // Work done by one operation, for the throughput column (e.g. bytes parsed), 0 for none
+    double itemsPerOp;
+    const char* itemUnit;
+    // Builds the fixture and returns the operation to time
+    std::function<Operation()> setup;
+};
+
+struct Measurement {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+    double throughput = 0.0;
+    const char* throughputUnit = "";
+};
+
+// Repetitions per benchmark, the median is reported
+const int REPETITIONS = 5;
+
+double runBatch(const Operation& operation, std::uint64_t iterations) {
+    auto begin = Clock::now();
+    for(std::uint64_t i = 0; i < iterations; i++) operation();
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+}
+
+Measurement measure(const Benchmark& benchmark, double minSeconds) {
+    Measurement result;
+    result.name = benchmark.name;
+    Operation operation = benchmark.setup();
+
+    // Grow the batch until one repetition takes its share of the time budget
+    const double targetNs = minSeconds * 1e9 / REPETITIONS;
+    std::uint64_t iterations = 1;
+    double elapsed = runBatch(operation, iterations);
+    while(elapsed < targetNs && iterations < (std::uint64_t{1} << 40)) {
+        double scale = elapsed > 0.0 ? targetNs / elapsed : 100.0;
+        iterations = std::max(iterations + 1, static_cast<std::uint64_t>(iterations * std::min(scale * 1.2, 100.0)));
+        elapsed = runBatch(operation, iterations);
+        if(elapsed >= targetNs) break;
+    }
+
+    // Reserved before counting, so only the operation's own allocations are seen
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(REPETITIONS);
+    std::uint64_t allocations = AllocationTracker::getAllocationCount();
+    std::uint64_t bytes = AllocationTracker::getAllocatedBytes();
+    for(int r = 0; r < REPETITIONS; r++) {
+        nsPerOp.push_back(runBatch(operation, iterations) / iterations);
+    }
+    allocations = AllocationTracker::getAllocationCount() - allocations;
+    bytes = AllocationTracker::getAllocatedBytes() - bytes;
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.iterations = iterations * REPETITIONS;
+    result.nsPerOp = nsPerOp[REPETITIONS / 2];
+    result.allocsPerOp = static_cast<double>(allocations) / result.iterations;
+    result.bytesPerOp = static_cast<double>(bytes) / result.iterations;
+    if(benchmark.itemsPerOp > 0.0) {
+        result.throughput = benchmark.itemsPerOp * 1e9 / result.nsPerOp;
+        result.throughputUnit = benchmark.itemUnit;
+    } else {
+        result.throughput = 1e9 / result.nsPerOp;
+        result.throughputUnit = "op/s";
+    }
+    return result;
+}
+
+
+
+// ========== Fixtures =============
+enum class GridShape {
+    // No walls at all
+    Open,
+    // Wall columns with one gap each, alternating top and bottom: a single long serpentine path
+    Mazy,
+    // The goal is walled in, the search has to exhaust the map
+    Unreachable,
+};
+
+const char* shapeName(GridShape shape) {
+    switch(shape) {
+        case GridShape::Open: return "open";
+        case GridShape::Mazy: return "mazy";
+        case GridShape::Unreachable: return "unreachable";
+    }
+    return "";
+}
+
+TileGrid makeGrid(GridShape shape, int size) {
+    TileGrid grid(size, size);
+    if(shape == GridShape::Mazy) {
+        for(int x = 1; x < size - 1; x += 2) {
+            int gap = (x / 2) % 2 == 0 ? size - 1 : 0;
+            for(int y = 0; y < size; y++) {
+                if(y != gap) grid.setTile(x, y, SYMBOL_WALL);
+            }
+        }
+    } else if(shape == GridShape::Unreachable) {
+        grid.setTile(size - 2, size - 1, SYMBOL_WALL);
+        grid.setTile(size - 1, size - 2, SYMBOL_WALL);
+        grid.setTile(size - 2, size - 2, SYMBOL_WALL);
+    }
+    return grid;
+}
+
+// Square stage with a tenth of the tiles walled, monsters split evenly between trace and guard monsters
+StageDefinition makeStage(int size, int monsters, int dispensers, std::uint64_t seed) {
+    GeneratorOptions options;
+    options.column = size;
+    options.row = size;
+    options.traceMonsters = monsters - monsters / 2;
+    options.guardMonsters = monsters / 2;
+    options.dispensers = dispensers;
+    options.seed = seed;
+    return StageGenerator::generate(options);
+}
+
+std::string makeStagePack(int stages, int size) {
+    std::string text;
+    for(int i = 0; i < stages; i++) {
+        StageDefinition definition = makeStage(size, size / 2, size / 4, i + 1);
+        definition.stageId = i + 1;
+        StageGenerator::appendStageText(text, definition);
+    }
+    return text;
+}
+
+std::vector<Benchmark> allBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    for(GridShape shape : {GridShape::Open, GridShape::Mazy, GridShape::Unreachable}) {
+        for(int size : {32, 128, 512}) {
+            benchmarks.push_back({std::string("pathfind/") + shapeName(shape) + "/" + std::to_string(size), 0.0, "", [shape, size] {
+                auto grid = std::make_shared<TileGrid>(makeGrid(shape, size));
+                auto pathfinder = std::make_shared<Pathfinder>();
+                return Operation([grid, pathfinder, size] {
+                    pathfinder->findPath({0, 0}, {size - 1, size - 1}, *grid);
+                });
+            }});
+        }
+    }
+
+    struct Population { int monsters; int dispensers; };
+    for(Population population : {Population{0, 0}, Population{10, 5}, Population{100, 50}, Population{1000, 500}}) {
+        std::string params = "/monsters=" + std::to_string(population.monsters) + ",dispensers=" + std::to_string(population.dispensers);
+
+        // Stage::advance is Simulation::advance plus a state change for the clear screen
+        benchmarks.push_back({"advance" + params, 1.0, "turn/s", [population] {
+            auto simulation = std::make_shared<Simulation>(makeStage(128, population.monsters, population.dispensers, 1));
+            return Operation([simulation] {
+                simulation->addAction(Action::None);
+                simulation->advance();
+            });
+        }});
+
+        benchmarks.push_back({"reset" + params, 0.0, "", [population] {
+            auto simulation = std::make_shared<Simulation>(makeStage(128, population.monsters, population.dispensers, 1));
+            // Let arrows fly and monsters move, so reset has something to undo the first time
+            for(int i = 0; i < 20; i++) simulation->step(Action::None);
+            return Operation([simulation] { simulation->reset(); });
+        }});
+    }
+
+    // Stage::createFromFile only parses (stages are built on first play), the build benchmark adds that
+    for(int stages : {10, 1000}) {
+        std::string params = "/stages=" + std::to_string(stages);
+        auto text = std::make_shared<std::string>(makeStagePack(stages, 32));
+        double megabytes = text->size() / 1e6;
+
+        benchmarks.push_back({"parse" + params, megabytes, "MB/s", [text] {
+            return Operation([text] {
+                std::vector<StageDefinition> definitions;
+                std::vector<ParseDiagnostic> diagnostics;
+                StageParser::parse(text->data(), text->size(), definitions, diagnostics);
+            });
+        }});
+
+        benchmarks.push_back({"parse+build" + params, megabytes, "MB/s", [text] {
+            return Operation([text] {
+                std::vector<StageDefinition> definitions;
+                std::vector<ParseDiagnostic> diagnostics;
+                StageParser::parse(text->data(), text->size(), definitions, diagnostics);
+                std::vector<Simulation> simulations;
+                simulations.reserve(definitions.size());
+                for(const StageDefinition& definition : definitions) simulations.emplace_back(definition);
+            });
+        }});
+    }
+
+    for(const char* pattern : {"UDLR", "U2R2D4L2U2", "U100D100L100R100"}) {
+        std::string source = pattern;
+        benchmarks.push_back({"processPattern/" + source, 0.0, "", [source] {
+            return Operation([source] {
+                std::string expanded = processPattern(source);
+                if(expanded.empty()) std::abort();
+            });
+        }});
+    }
+
+    return benchmarks;
+}
+
+
+
+// ========== Output =============
+void writeJson(const std::string& filename, const std::vector<Measurement>& measurements) {
+    FILE* file = std::fopen(filename.c_str(), "w");
+    if(!file) {
+        std::fprintf(stderr, "Cannot write %s\n", filename.c_str());
+        return;
+    }
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    std::fprintf(file, "{\n  \"context\": {\"date\": \"%s\", \"compiler\": \"%s\", \"repetitions\": %d},\n  \"benchmarks\": [",
+        date, __VERSION__, REPETITIONS);
+    for(std::size_t i = 0; i < measurements.size(); i++) {
+        const Measurement& m = measurements[i];
+        std::fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.4f, "
+            "\"bytes_per_op\": %.1f, \"throughput\": %.2f, \"throughput_unit\": \"%s\"}",
+            i == 0 ? "" : ",", m.name.c_str(), static_cast<unsigned long long>(m.iterations), m.nsPerOp, m.allocsPerOp,
+            m.bytesPerOp, m.throughput, m.throughputUnit);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    std::fclose(file);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string jsonFile;
+    double minSeconds = 0.5;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if(arg == "--min-time" && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if(arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else {
+            std::printf("Usage: %s [--filter TEXT] [--min-time SECONDS] [--json FILE]\n", argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+
+    std::vector<Measurement> measurements;
+    std::printf("%-44s %14s %12s %12s %16s\n", "benchmark", "ns/op", "allocs/op", "bytes/op", "throughput");
+    for(const Benchmark& benchmark : allBenchmarks()) {
+        if(!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+        Measurement m = measure(benchmark, minSeconds);
+        std::printf("%-44s %14.1f %12.2f %12.1f %11.3g %s\n",
+            m.name.c_str(), m.nsPerOp, m.allocsPerOp, m.bytesPerOp, m.throughput, m.throughputUnit);
+        std::fflush(stdout);
+        measurements.push_back(m);
+    }
+
+    if(!jsonFile.empty()) writeJson(jsonFile, measurements);
+    return 0;
+}
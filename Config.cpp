@@ -1,4 +1,4 @@
-#include "Constants.hpp"
+#include "Config.hpp"
 #include "Logger.hpp"
 #include <fstream>
 #include <sstream>
@@ -14,11 +14,11 @@ float Config::ZOOM_RATE = 0.1f;
 void Config::init(const std::string& configFile) {
     std::ifstream file(configFile);
     if(!file.is_open()) {
-        Logger::log("Warning: Config file '" + configFile + "' not found. Using default values.");
+        LOG_INFO("Warning: Config file '" + configFile + "' not found. Using default values.");
         return;
     }
 
-    Logger::log("Loading configuration from " + configFile + "...");
+    LOG_INFO("Loading configuration from " + configFile + "...");
     std::string line;
     int lineNum = 0;
     
@@ -50,33 +50,33 @@ void Config::init(const std::string& configFile) {
         try {
             if(key == "DEBUG_MODE") {
                 DEBUG_MODE = (value == "true" || value == "1");
-                Logger::log("  DEBUG_MODE = " + std::string(DEBUG_MODE ? "true" : "false"));
+                LOG_INFO("  DEBUG_MODE = " + std::string(DEBUG_MODE ? "true" : "false"));
             }
             else if(key == "WORLD_WIDTH") {
                 WORLD_WIDTH = std::stoi(value);
-                Logger::log("  WORLD_WIDTH = " + std::to_string(WORLD_WIDTH));
+                LOG_INFO("  WORLD_WIDTH = " + std::to_string(WORLD_WIDTH));
             }
             else if(key == "WORLD_HEIGHT") {
                 WORLD_HEIGHT = std::stoi(value);
-                Logger::log("  WORLD_HEIGHT = " + std::to_string(WORLD_HEIGHT));
+                LOG_INFO("  WORLD_HEIGHT = " + std::to_string(WORLD_HEIGHT));
             }
             else if(key == "FRAME_RATE") {
                 FRAME_RATE = std::stoi(value);
-                Logger::log("  FRAME_RATE = " + std::to_string(FRAME_RATE));
+                LOG_INFO("  FRAME_RATE = " + std::to_string(FRAME_RATE));
             }
             else if(key == "BGM_VOLUME") {
                 BGM_VOLUME = std::stof(value);
-                Logger::log("  BGM_VOLUME = " + std::to_string(BGM_VOLUME));
+                LOG_INFO("  BGM_VOLUME = " + std::to_string(BGM_VOLUME));
             }
             else if(key == "ZOOM_RATE") {
                 ZOOM_RATE = std::stof(value);
-                Logger::log("  ZOOM_RATE = " + std::to_string(ZOOM_RATE));
+                LOG_INFO("  ZOOM_RATE = " + std::to_string(ZOOM_RATE));
             }
         } catch(const std::exception& e) {
-            Logger::log("Error parsing config line " + std::to_string(lineNum) + ": " + key + " = " + value);
+            LOG_INFO("Error parsing config line " + std::to_string(lineNum) + ": " + key + " = " + value);
         }
     }
     
     file.close();
-    Logger::log("Configuration loaded successfully.");
+    LOG_INFO("Configuration loaded successfully.");
 }
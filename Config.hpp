@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+// Configuration class to load settings from file
+class Config {
+public:
+    // Global settings
+    static bool DEBUG_MODE;
+    static int WORLD_WIDTH;
+    static int WORLD_HEIGHT;
+    static int FRAME_RATE;
+    static float BGM_VOLUME;
+    static float ZOOM_RATE;
+    
+    // Load configuration from file
+    static void init(const std::string& configFile = "config.txt");
+    
+private:
+    Config() = delete;
+    ~Config() = delete;
+};
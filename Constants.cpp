@@ -1,6 +1,7 @@
 #include "Constants.hpp"
 #include "Logger.hpp"
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 
 // Define static member
 sf::Image Resource::icon;
@@ -22,89 +23,129 @@ sf::Texture Resource::traceMonsterTexture;
 sf::Texture Resource::dispenserTexture;
 sf::Texture Resource::arrowTexture;
 sf::Texture Resource::trapTexture;
+sf::Texture Resource::atlasTexture;
+sf::IntRect Resource::atlasRects[static_cast<int>(AtlasTile::Count)];
 
 void Resource::init() {
     // Load icon
     if(!icon.loadFromFile(ICON_FILE)) {
-        Logger::log("Failed to load icon file: " + ICON_FILE);
+        LOG_INFO("Failed to load icon file: " + ICON_FILE);
     }
 
     // Load music
     if(!music.openFromFile(BGM_FILE)) {
-        Logger::log("Failed to load BGM file: " + BGM_FILE);
+        LOG_INFO("Failed to load BGM file: " + BGM_FILE);
     } else {
         music.play();
-        music.setVolume(BGM_VOLUME);
+        music.setVolume(Config::BGM_VOLUME);
         music.setLooping(true);
     }
 
     // Load textures
     if(!titleTexture.loadFromFile(TITLE_IMAGE_FILE)) {
-        Logger::log("Failed to load title texture: " + TITLE_IMAGE_FILE);
+        LOG_INFO("Failed to load title texture: " + TITLE_IMAGE_FILE);
     }
 
     if(!backgroundTitleTexture.loadFromFile(BACKGROUND_TITLE_FILE)) {
-        Logger::log("Failed to load title background texture: " + BACKGROUND_TITLE_FILE);
+        LOG_INFO("Failed to load title background texture: " + BACKGROUND_TITLE_FILE);
     }
 
     if(!backgroundStageTexture.loadFromFile(BACKGROUND_STAGE_FILE)) {
-        Logger::log("Failed to load stage background texture: " + BACKGROUND_STAGE_FILE);
+        LOG_INFO("Failed to load stage background texture: " + BACKGROUND_STAGE_FILE);
     }
 
     if(!stageClearTexture.loadFromFile(STAGE_CLEAR_FILE)) {
-        Logger::log("Failed to load stage clear texture: " + STAGE_CLEAR_FILE);
+        LOG_INFO("Failed to load stage clear texture: " + STAGE_CLEAR_FILE);
     }
     
     if(!buttonFont.openFromFile(BUTTON_FONT_FILE)) {
-        Logger::log("Failed to load button font file: " + BUTTON_FONT_FILE);
-    }
-
-    if(!playerTexture.loadFromFile(PLAYER_TEXTURE_FILE)) {
-        Logger::log("Failed to load player texture: " + PLAYER_TEXTURE_FILE);
-    }
-
-    if(!openSpaceTexture1.loadFromFile(OPEN_SPACE_1_TEXTURE_FILE)) {
-        Logger::log("Failed to load open space texture 1: " + OPEN_SPACE_1_TEXTURE_FILE);
-    }
-
-    if(!openSpaceTexture2.loadFromFile(OPEN_SPACE_2_TEXTURE_FILE)) {
-        Logger::log("Failed to load open space texture 2: " + OPEN_SPACE_2_TEXTURE_FILE);
-    }
-
-    if(!openSpaceTexture3.loadFromFile(OPEN_SPACE_3_TEXTURE_FILE)) {
-        Logger::log("Failed to load open space texture 3: " + OPEN_SPACE_3_TEXTURE_FILE);
-    }
-
-    if(!openSpaceTexture4.loadFromFile(OPEN_SPACE_4_TEXTURE_FILE)) {
-        Logger::log("Failed to load open space texture 4: " + OPEN_SPACE_4_TEXTURE_FILE);
-    }
-
-    if(!wallTexture.loadFromFile(WALL_TEXTURE_FILE)) {
-        Logger::log("Failed to load wall texture: " + WALL_TEXTURE_FILE);
-    }
-
-    if(!goalTexture.loadFromFile(GOAL_TEXTURE_FILE)) {
-        Logger::log("Failed to load goal texture: " + GOAL_TEXTURE_FILE);
-    }
-
-    if(!guardMonsterTexture.loadFromFile(GUARD_MONSTER_TEXTURE_FILE)) {
-        Logger::log("Failed to load guard monster texture: " + GUARD_MONSTER_TEXTURE_FILE);
-    }
-
-    if(!traceMonsterTexture.loadFromFile(TRACE_MONSTER_TEXTURE_FILE)) {
-        Logger::log("Failed to load trace monster texture: " + TRACE_MONSTER_TEXTURE_FILE);
-    }
-
-    if(!dispenserTexture.loadFromFile(DISPENSER_TEXTURE_FILE)) {
-        Logger::log("Failed to load dispenser texture: " + DISPENSER_TEXTURE_FILE);
-    }
-
-    if(!arrowTexture.loadFromFile(ARROW_TEXTURE_FILE)) {
-        Logger::log("Failed to load arrow texture: " + ARROW_TEXTURE_FILE);
-    }
-
-    if(!trapTexture.loadFromFile(TRAP_TEXTURE_FILE)) {
-        Logger::log("Failed to load trap texture: " + TRAP_TEXTURE_FILE);
+        LOG_INFO("Failed to load button font file: " + BUTTON_FONT_FILE);
+    }
+
+    // Tile and entity textures are loaded once as images,
+    // then uploaded on their own and packed into the atlas
+    const struct {
+        sf::Texture* texture;
+        const std::string* file;
+        AtlasTile tile;
+    } tileTextures[] = {
+        {&openSpaceTexture1, &OPEN_SPACE_1_TEXTURE_FILE, AtlasTile::OpenSpace1},
+        {&openSpaceTexture2, &OPEN_SPACE_2_TEXTURE_FILE, AtlasTile::OpenSpace2},
+        {&openSpaceTexture3, &OPEN_SPACE_3_TEXTURE_FILE, AtlasTile::OpenSpace3},
+        {&openSpaceTexture4, &OPEN_SPACE_4_TEXTURE_FILE, AtlasTile::OpenSpace4},
+        {&wallTexture, &WALL_TEXTURE_FILE, AtlasTile::Wall},
+        {&goalTexture, &GOAL_TEXTURE_FILE, AtlasTile::Goal},
+        {&playerTexture, &PLAYER_TEXTURE_FILE, AtlasTile::Player},
+        {&traceMonsterTexture, &TRACE_MONSTER_TEXTURE_FILE, AtlasTile::TraceMonster},
+        {&guardMonsterTexture, &GUARD_MONSTER_TEXTURE_FILE, AtlasTile::GuardMonster},
+        {&dispenserTexture, &DISPENSER_TEXTURE_FILE, AtlasTile::Dispenser},
+        {&arrowTexture, &ARROW_TEXTURE_FILE, AtlasTile::Arrow},
+        {&trapTexture, &TRAP_TEXTURE_FILE, AtlasTile::Trap},
+    };
+
+    const unsigned stride = ATLAS_CELL_SIZE + 2 * ATLAS_CELL_PADDING;
+    const unsigned atlasRows = (static_cast<unsigned>(AtlasTile::Count) + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    sf::Image atlasImage({ATLAS_COLUMNS * stride, atlasRows * stride}, sf::Color::Transparent);
+
+    for(const auto& entry : tileTextures) {
+        sf::Image image;
+        if(!image.loadFromFile(*entry.file) || !entry.texture->loadFromImage(image)) {
+            LOG_INFO("Failed to load texture: " + *entry.file);
+            continue;
+        }
+        packAtlasCell(atlasImage, image, entry.tile);
+    }
+
+    if(!atlasTexture.loadFromImage(atlasImage)) {
+        LOG_INFO("Failed to create texture atlas.");
+    }
+    // Cells are scaled to the tile size when drawn
+    atlasTexture.setSmooth(true);
+}
+
+void Resource::packAtlasCell(sf::Image& atlas, const sf::Image& image, AtlasTile tile) {
+    const unsigned stride = ATLAS_CELL_SIZE + 2 * ATLAS_CELL_PADDING;
+    int index = static_cast<int>(tile);
+    unsigned originX = (index % ATLAS_COLUMNS) * stride + ATLAS_CELL_PADDING;
+    unsigned originY = (index / ATLAS_COLUMNS) * stride + ATLAS_CELL_PADDING;
+    atlasRects[index] = sf::IntRect({static_cast<int>(originX), static_cast<int>(originY)},
+        {static_cast<int>(ATLAS_CELL_SIZE), static_cast<int>(ATLAS_CELL_SIZE)});
+
+    // Box filter: every cell pixel is the average of the source pixels it covers
+    sf::Vector2u sourceSize = image.getSize();
+    if(sourceSize.x == 0 || sourceSize.y == 0) return;
+    for(unsigned y = 0; y < ATLAS_CELL_SIZE; y++) {
+        unsigned y0 = y * sourceSize.y / ATLAS_CELL_SIZE;
+        unsigned y1 = std::max(y0 + 1, (y + 1) * sourceSize.y / ATLAS_CELL_SIZE);
+        for(unsigned x = 0; x < ATLAS_CELL_SIZE; x++) {
+            unsigned x0 = x * sourceSize.x / ATLAS_CELL_SIZE;
+            unsigned x1 = std::max(x0 + 1, (x + 1) * sourceSize.x / ATLAS_CELL_SIZE);
+
+            unsigned r = 0, g = 0, b = 0, a = 0;
+            for(unsigned sy = y0; sy < y1; sy++) {
+                for(unsigned sx = x0; sx < x1; sx++) {
+                    sf::Color color = image.getPixel({sx, sy});
+                    r += color.r;
+                    g += color.g;
+                    b += color.b;
+                    a += color.a;
+                }
+            }
+            unsigned count = (x1 - x0) * (y1 - y0);
+            atlas.setPixel({originX + x, originY + y}, sf::Color(r / count, g / count, b / count, a / count));
+        }
+    }
+
+    // Repeat the edge pixels into the padding
+    for(unsigned y = 0; y < ATLAS_CELL_SIZE + 2 * ATLAS_CELL_PADDING; y++) {
+        for(unsigned x = 0; x < ATLAS_CELL_SIZE + 2 * ATLAS_CELL_PADDING; x++) {
+            unsigned cellX = std::min(std::max(x, ATLAS_CELL_PADDING), ATLAS_CELL_PADDING + ATLAS_CELL_SIZE - 1);
+            unsigned cellY = std::min(std::max(y, ATLAS_CELL_PADDING), ATLAS_CELL_PADDING + ATLAS_CELL_SIZE - 1);
+            if(cellX == x && cellY == y) continue;
+            unsigned baseX = originX - ATLAS_CELL_PADDING;
+            unsigned baseY = originY - ATLAS_CELL_PADDING;
+            atlas.setPixel({baseX + x, baseY + y}, atlas.getPixel({baseX + cellX, baseY + cellY}));
+        }
     }
 }
 
@@ -176,4 +217,21 @@ const sf::Texture& Resource::getArrowTexture() {
 
 const sf::Texture& Resource::getTrapTexture() {
     return trapTexture;
-}
\ No newline at end of file
+}
+
+const sf::Texture& Resource::getAtlasTexture() {
+    return atlasTexture;
+}
+
+const sf::IntRect& Resource::getAtlasRect(AtlasTile tile) {
+    return atlasRects[static_cast<int>(tile)];
+}
+
+AtlasTile Resource::getOpenSpaceTile(int variant) {
+    switch(variant) {
+        case 2: return AtlasTile::OpenSpace2;
+        case 3: return AtlasTile::OpenSpace3;
+        case 4: return AtlasTile::OpenSpace4;
+        default: return AtlasTile::OpenSpace1; // Default to variant 1 if invalid
+    }
+}
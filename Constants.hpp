@@ -2,6 +2,8 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <string>
+#include "Config.hpp"
+#include "Types.hpp"
 
 enum class GameState {
     TitleScreen,
@@ -11,34 +13,6 @@ enum class GameState {
     StageClear,
 };
 
-enum class Action {
-    MoveUp,
-    MoveDown,
-    MoveLeft,
-    MoveRight,
-    Attack,
-    None,
-};
-
-// Configuration class to load settings from file
-class Config {
-public:
-    // Global settings
-    static bool DEBUG_MODE;
-    static int WORLD_WIDTH;
-    static int WORLD_HEIGHT;
-    static int FRAME_RATE;
-    static float BGM_VOLUME;
-    static float ZOOM_RATE;
-    
-    // Load configuration from file
-    static void init(const std::string& configFile = "config.txt");
-    
-private:
-    Config() = delete;
-    ~Config() = delete;
-};
-
 // Resource files
 inline const std::string GAME_TITLE = "Solipsism";
 inline const std::string ICON_FILE = "assets/icon.png";
@@ -77,27 +51,34 @@ inline const sf::Color TILE_COLOR_DISPENSER = sf::Color(240, 131, 0);
 inline const sf::Color TILE_COLOR_TRACE_MONSTER = sf::Color(217, 51, 63);
 inline const sf::Color TILE_COLOR_GUARD_MONSTER = sf::Color(239, 171, 147);
 
-// Object symbols
-inline const char SYMBOL_PLAYER = 'P';
-inline const char SYMBOL_GOAL = 'G';
-inline const char SYMBOL_WALL = 'X';
-inline const char SYMBOL_OPEN_SPACE = '-';
-inline const char SYMBOL_DISPENSER = 'D';
-inline const char SYMBOL_TRACE_MONSTER = 'M';
-inline const char SYMBOL_GUARD_MONSTER = 'm';
-inline const char SYMBOL_ARROW = 'A';
-
-// Direction symbols
-inline const char SYMBOL_UP = 'U';
-inline const char SYMBOL_DOWN = 'D';
-inline const char SYMBOL_LEFT = 'L';
-inline const char SYMBOL_RIGHT = 'R';
+// Texture atlas: every tile and entity texture is scaled into one square cell
+inline const unsigned ATLAS_CELL_SIZE = 128;
+// Edge pixels repeated around each cell, so smoothing never samples the neighboring cell
+inline const unsigned ATLAS_CELL_PADDING = 2;
+inline const unsigned ATLAS_COLUMNS = 4;
+
+// Cells of the texture atlas
+enum class AtlasTile {
+    OpenSpace1,
+    OpenSpace2,
+    OpenSpace3,
+    OpenSpace4,
+    Wall,
+    Goal,
+    Player,
+    TraceMonster,
+    GuardMonster,
+    Dispenser,
+    Arrow,
+    Trap,
+    Count,
+};
 
 // Default Button Settings
 inline const float BUTTON_WIDTH = 240.0f;
 inline const float BUTTON_HEIGHT = 80.0f;
-inline const float BUTTON_CENTER_X = WORLD_WIDTH / 2.f;
-inline const float BUTTON_CENTER_Y = WORLD_HEIGHT / 2.f + 100.f; // 100 pixels below center
+inline const float BUTTON_CENTER_X = Config::WORLD_WIDTH / 2.f;
+inline const float BUTTON_CENTER_Y = Config::WORLD_HEIGHT / 2.f + 100.f; // 100 pixels below center
 inline const float BUTTON_CIRCLE_RADIUS = 30.f;
 inline const float BUTTON_RECTANGLE_WIDTH = BUTTON_WIDTH - 2 * BUTTON_CIRCLE_RADIUS;
 inline const float BUTTON_RECTANGLE_HEIGHT = BUTTON_HEIGHT - 2 * BUTTON_CIRCLE_RADIUS;
@@ -106,32 +87,6 @@ inline const sf::Color BUTTON_RECTANGLE_COLOR = sf::Color(40, 40, 40);
 inline const sf::Color BUTTON_SHADOW_COLOR = sf::Color(0, 0, 0, 150);
 inline const sf::Color BUTTON_TEXT_COLOR = sf::Color(200, 200, 200);
 
-class Config {
-private:
-    static bool DEBUG_MODE;
-    static int WORLD_WIDTH;
-    static int WORLD_HEIGHT;
-    static int FRAME_RATE;
-
-public:
-    Config() = delete;
-    ~Config() = delete;
-
-    static void init();
-
-    static bool isDebugMode();
-    static void setDebugMode(bool debug);
-
-    static int getWorldWidth();
-    static void setWorldWidth(int width);
-
-    static int getWorldHeight();
-    static void setWorldHeight(int height);
-
-    static int getFrameRate();
-    static void setFrameRate(int frameRate);
-};
-
 class Resource {
 private:
     static sf::Image icon;
@@ -153,6 +108,12 @@ private:
     static sf::Texture dispenserTexture;
     static sf::Texture arrowTexture;
     static sf::Texture trapTexture;
+    // All tile and entity textures in one texture, so a whole layer is one draw call
+    static sf::Texture atlasTexture;
+    static sf::IntRect atlasRects[static_cast<int>(AtlasTile::Count)];
+
+    // Scale an image into its atlas cell and fill the cell padding
+    static void packAtlasCell(sf::Image& atlas, const sf::Image& image, AtlasTile tile);
 
 public:
     Resource() = delete;
@@ -175,4 +136,9 @@ public:
     static const sf::Texture& getDispenserTexture();
     static const sf::Texture& getArrowTexture();
     static const sf::Texture& getTrapTexture();
+    static const sf::Texture& getAtlasTexture();
+    // Pixel rectangle of a cell inside the atlas texture
+    static const sf::IntRect& getAtlasRect(AtlasTile tile);
+    // Open space cell for a variant number (1~4)
+    static AtlasTile getOpenSpaceTile(int variant);
 };
\ No newline at end of file
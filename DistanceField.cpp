@@ -0,0 +1,83 @@
+#include "DistanceField.hpp"
+#include "Types.hpp"
+#include <algorithm>
+
+void DistanceField::compute(const sf::Vector2i& target, const TileGrid& tileMap) {
+    rows = tileMap.getRow();
+    cols = tileMap.getColumn();
+    stride = tileMap.getStride();
+    neighborOffsets = tileMap.getNeighborOffsets();
+    this->target = target;
+    computed = true;
+
+    size_t count = tileMap.getCellCount();
+    distance.assign(count, UNREACHABLE);
+    frontier.resize(count);
+
+    if(!tileMap.contains(target)) return;
+
+    // The frontier never holds a tile twice, so a flat array with head/tail indices is enough
+    // TraceMonsters may path through other monsters and arrows, only walls and dispensers block
+    // The wall border is never walkable, so neighbors need no bounds check
+    int head = 0;
+    int tail = 0;
+    int targetIndex = tileMap.index(target);
+    distance[targetIndex] = 0;
+    frontier[tail++] = targetIndex;
+
+    while(head < tail) {
+        int current = frontier[head++];
+        int nextDistance = distance[current] + 1;
+
+        for(int offset : neighborOffsets) {
+            int neighbor = current + offset;
+            if(distance[neighbor] != UNREACHABLE || tileMap.hasAny(TileGrid::BLOCKING, neighbor)) continue;
+
+            distance[neighbor] = nextDistance;
+            frontier[tail++] = neighbor;
+        }
+    }
+}
+
+bool DistanceField::isComputedFor(const sf::Vector2i& target) const {
+    return computed && this->target == target;
+}
+
+void DistanceField::invalidate() {
+    computed = false;
+}
+
+int DistanceField::getDistance(const sf::Vector2i& pos) const {
+    if(!computed || pos.x < 0 || pos.x >= cols || pos.y < 0 || pos.y >= rows) return UNREACHABLE;
+    return distance[(pos.y + 1) * stride + (pos.x + 1)];
+}
+
+bool DistanceField::getNextStep(const sf::Vector2i& from, sf::Vector2i& next) const {
+    int current = getDistance(from);
+    if(current <= 0) return false; // At the target or unreachable
+
+    int fromIndex = (from.y + 1) * stride + (from.x + 1);
+    for(int i = 0; i < TileGrid::NEIGHBOR_COUNT; i++) {
+        if(distance[fromIndex + neighborOffsets[i]] == current - 1) {
+            next = {from.x + TileGrid::NEIGHBOR_DX[i], from.y + TileGrid::NEIGHBOR_DY[i]};
+            return true;
+        }
+    }
+    return false;
+}
+
+int DistanceField::countNextSteps(const sf::Vector2i& from) const {
+    int current = getDistance(from);
+    if(current <= 0) return 0;
+
+    int fromIndex = (from.y + 1) * stride + (from.x + 1);
+    int count = 0;
+    for(int offset : neighborOffsets) {
+        if(distance[fromIndex + offset] == current - 1) count++;
+    }
+    return count;
+}
+
+const sf::Vector2i& DistanceField::getTarget() const {
+    return target;
+}
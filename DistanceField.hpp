@@ -0,0 +1,46 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "TileGrid.hpp"
+#include <array>
+#include <vector>
+
+// Breadth-first distance map towards a single target tile.
+// Every TraceMonster chases the player, so one field per action step
+// replaces one A* search per monster.
+class DistanceField {
+public:
+    static constexpr int UNREACHABLE = -1;
+
+    DistanceField() = default;
+
+    // Run a reverse BFS from target over walkable tiles (everything except walls and dispensers)
+    void compute(const sf::Vector2i& target, const TileGrid& tileMap);
+    // Whether the field already holds distances towards target
+    bool isComputedFor(const sf::Vector2i& target) const;
+    // Forget the current field so the next compute() always runs
+    void invalidate();
+
+    // Steps from pos to the target, or UNREACHABLE
+    int getDistance(const sf::Vector2i& pos) const;
+    // Neighbor of from that lies one step closer to the target (Up, Down, Left, Right priority)
+    // Returns false if from is the target itself or cannot reach it
+    bool getNextStep(const sf::Vector2i& from, sf::Vector2i& next) const;
+    // Number of neighbors of from that lie one step closer to the target
+    int countNextSteps(const sf::Vector2i& from) const;
+    // Tile the distances lead to
+    const sf::Vector2i& getTarget() const;
+
+private:
+    int rows = 0;
+    int cols = 0;
+    // Grid layout the distances are stored in (indices include the wall border)
+    int stride = 0;
+    std::array<int, 4> neighborOffsets = {};
+    bool computed = false;
+    sf::Vector2i target;
+
+    // Distances per grid cell, reused between computations (the border stays UNREACHABLE)
+    std::vector<int> distance;
+    // BFS queue of tile indices, reused between computations
+    std::vector<int> frontier;
+};
@@ -0,0 +1,239 @@
+#include "Logger.hpp"
+#include "Object.hpp"
+#include "EntityStore.hpp"
+
+// ========== PatternedEntities =============
+int PatternedEntities::size() const {
+    return static_cast<int>(positions.size());
+}
+
+void PatternedEntities::add(sf::Vector2i position, CompiledPattern pattern) {
+    positions.push_back(position);
+    patterns.push_back(std::move(pattern));
+    cursors.push_back(0);
+}
+
+bool PatternedEntities::hasPattern(int i) const {
+    return patterns[i] && !patterns[i]->empty();
+}
+
+char PatternedEntities::currentStep(int i) const {
+    return (*patterns[i])[cursors[i]];
+}
+
+void PatternedEntities::advanceCursor(int i) {
+    if(++cursors[i] == static_cast<int>(patterns[i]->size())) cursors[i] = 0;
+}
+
+void PatternedEntities::setCursor(int i, int cursor) {
+    if(!hasPattern(i)) return;
+    cursors[i] = cursor % static_cast<int>(patterns[i]->size());
+}
+
+
+
+// ========== EntityStore =============
+void EntityStore::addTraceMonster(sf::Vector2i position) {
+    actors.push_back({EntityKind::TraceMonster, static_cast<int>(traceMonsters.size())});
+    traceMonsters.push_back(position);
+    LOG_INFO("TraceMonster created at tile ("
+        + std::to_string(position.x) + ", " + std::to_string(position.y) + ").");
+}
+
+void EntityStore::addGuardMonster(sf::Vector2i position, CompiledPattern pattern) {
+    size_t steps = pattern ? pattern->size() : 0;
+    actors.push_back({EntityKind::GuardMonster, guardMonsters.size()});
+    guardMonsters.add(position, std::move(pattern));
+    LOG_INFO("GuardMonster created at tile ("
+        + std::to_string(position.x) + ", " + std::to_string(position.y) + ") "
+        + "with a behavior pattern of " + std::to_string(steps) + " steps.");
+}
+
+void EntityStore::addDispenser(sf::Vector2i position, CompiledPattern pattern) {
+    actors.push_back({EntityKind::Dispenser, dispensers.size()});
+    dispensers.add(position, std::move(pattern));
+    LOG_INFO("Dispenser created at tile ("
+        + std::to_string(position.x) + ", " + std::to_string(position.y) + ").");
+}
+
+ProjectileHandle EntityStore::addArrow(sf::Vector2i position, char direction) {
+    return arrows.spawn(position, direction);
+}
+
+void EntityStore::clearArrows() {
+    arrows.clear();
+}
+
+int EntityStore::actorCount() const {
+    return static_cast<int>(actors.size());
+}
+
+int EntityStore::arrowCount() const {
+    return arrows.size();
+}
+
+char EntityStore::getActorSymbol(int actor) const {
+    switch(actors[actor].kind) {
+        case EntityKind::TraceMonster: return SYMBOL_TRACE_MONSTER;
+        case EntityKind::GuardMonster: return SYMBOL_GUARD_MONSTER;
+        case EntityKind::Dispenser: return SYMBOL_DISPENSER;
+    }
+    return SYMBOL_OPEN_SPACE;
+}
+
+sf::Vector2i EntityStore::getActorPosition(int actor) const {
+    const ActorRef& ref = actors[actor];
+    switch(ref.kind) {
+        case EntityKind::TraceMonster: return traceMonsters[ref.index];
+        case EntityKind::GuardMonster: return guardMonsters.positions[ref.index];
+        case EntityKind::Dispenser: return dispensers.positions[ref.index];
+    }
+    return {0, 0};
+}
+
+int EntityStore::getActorCursor(int actor) const {
+    const ActorRef& ref = actors[actor];
+    switch(ref.kind) {
+        case EntityKind::TraceMonster: return 0;
+        case EntityKind::GuardMonster: return guardMonsters.cursors[ref.index];
+        case EntityKind::Dispenser: return dispensers.cursors[ref.index];
+    }
+    return 0;
+}
+
+void EntityStore::setActorState(int actor, sf::Vector2i position, int cursor) {
+    const ActorRef& ref = actors[actor];
+    switch(ref.kind) {
+        case EntityKind::TraceMonster:
+            traceMonsters[ref.index] = position;
+            break;
+        case EntityKind::GuardMonster:
+            guardMonsters.positions[ref.index] = position;
+            guardMonsters.setCursor(ref.index, cursor);
+            break;
+        case EntityKind::Dispenser:
+            dispensers.positions[ref.index] = position;
+            dispensers.setCursor(ref.index, cursor);
+            break;
+    }
+}
+
+void EntityStore::placeAll(TileGrid& tileMap) const {
+    for(const sf::Vector2i& position : traceMonsters) tileMap.place(TileLayer::Monster, tileMap.index(position));
+    for(const sf::Vector2i& position : guardMonsters.positions) tileMap.place(TileLayer::Monster, tileMap.index(position));
+    for(const sf::Vector2i& position : arrows.getPositions()) tileMap.place(TileLayer::Arrow, tileMap.index(position));
+}
+
+void EntityStore::liftAll(TileGrid& tileMap) const {
+    for(const sf::Vector2i& position : traceMonsters) tileMap.lift(TileLayer::Monster, tileMap.index(position));
+    for(const sf::Vector2i& position : guardMonsters.positions) tileMap.lift(TileLayer::Monster, tileMap.index(position));
+    for(const sf::Vector2i& position : arrows.getPositions()) tileMap.lift(TileLayer::Arrow, tileMap.index(position));
+}
+
+bool EntityStore::moveArrow(int i, TileGrid& tileMap, const WallRays& wallRays) {
+    sf::Vector2i posTile = arrows.getPosition(i);
+    LOG_DEBUG("Updating Arrow at ("
+        + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ").");
+    int index = tileMap.index(posTile);
+    tileMap.lift(TileLayer::Arrow, index);
+
+    // Blocked (or not moving at all), the arrow stops here
+    char direction = arrows.getDirection(i);
+    if(wallRays.range(index, direction) == 0) {
+        LOG_DEBUG("Arrow at (" + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ") stopped and will be removed.");
+        return false;
+    }
+
+    int newIndex = index + tileMap.directionOffset(direction);
+    sf::Vector2i newPosTile = tileMap.position(newIndex);
+    arrows.setPosition(i, newPosTile);
+    tileMap.place(TileLayer::Arrow, newIndex);
+    LOG_DEBUG("Arrow moved to (" + std::to_string(newPosTile.x) + ", " + std::to_string(newPosTile.y) + ").");
+    return true;
+}
+
+void EntityStore::updateTraceMonster(int i, TileGrid& tileMap, const DistanceField& playerDistance, Pathfinder& pathfinder) {
+    sf::Vector2i& posTile = traceMonsters[i];
+    LOG_DEBUG("Updating TraceMonster at ("
+        + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ").");
+
+    // Next step is read from the distance field shared by every trace monster
+    sf::Vector2i nextTilePos;
+    if(!playerDistance.getNextStep(posTile, nextTilePos)) {
+        // Surrounded or already on the player, stay in place
+        LOG_DEBUG("TraceMonster is blocked or at goal.");
+        return;
+    }
+    // The field only knows which neighbors are closer. Its Up, Down, Left, Right order would pick
+    // other paths than the A* search did, so a tie is left to the search itself
+    if(playerDistance.countNextSteps(posTile) > 1) {
+        nextTilePos = pathfinder.findPath(posTile, playerDistance.getTarget(), tileMap)[1];
+    }
+
+    // Other monsters and arrows block the way
+    int nextIndex = tileMap.index(nextTilePos);
+    if(tileMap.hasAny(TileGrid::DANGEROUS, nextIndex)) {
+        LOG_DEBUG("TraceMonster next position blocked by other Monster at ("
+            + std::to_string(nextTilePos.x) + ", " + std::to_string(nextTilePos.y) + ").");
+        return;
+    }
+
+    tileMap.lift(TileLayer::Monster, tileMap.index(posTile));
+    posTile = nextTilePos;
+    tileMap.place(TileLayer::Monster, nextIndex);
+
+    LOG_DEBUG("TraceMonster moved to (" + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ").");
+}
+
+void EntityStore::updateGuardMonster(int i, TileGrid& tileMap) {
+    sf::Vector2i& posTile = guardMonsters.positions[i];
+    LOG_DEBUG("Updating GuardMonster at ("
+        + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ").");
+    if(!guardMonsters.hasPattern(i)) return;
+
+    int index = tileMap.index(posTile);
+    int offset = tileMap.directionOffset(guardMonsters.currentStep(i));
+    int newIndex = index + offset;
+    // A blocked step is retried next turn
+    if(tileMap.hasAny(TileGrid::BLOCKING, newIndex)) {
+        LOG_DEBUG("GuardMonster step blocked by a wall or dispenser.");
+        return;
+    }
+    guardMonsters.advanceCursor(i);
+
+    // Steps other than a direction keep the monster in place
+    if(offset == 0) return;
+
+    tileMap.lift(TileLayer::Monster, index);
+    posTile = tileMap.position(newIndex);
+    tileMap.place(TileLayer::Monster, newIndex);
+
+    LOG_DEBUG("GuardMonster moved to ("
+        + std::to_string(posTile.x) + ", "
+        + std::to_string(posTile.y) + ").");
+}
+
+bool EntityStore::updateDispenser(int i, TileGrid& tileMap) {
+    const sf::Vector2i posTile = dispensers.positions[i];
+    LOG_DEBUG("Updating Dispenser at ("
+        + std::to_string(posTile.x) + ", " + std::to_string(posTile.y) + ").");
+    // Dispenser does not move, but it will project arrows based on its behavior pattern.
+    if(!dispensers.hasPattern(i)) return false;
+
+    char direction = dispensers.currentStep(i);
+    dispensers.advanceCursor(i);
+
+    // Arrows only spawn on an empty tile next to the dispenser
+    int offset = tileMap.directionOffset(direction);
+    int arrowIndex = tileMap.index(posTile) + offset;
+    if(offset == 0 || tileMap.hasAny(TileGrid::OCCUPIED, arrowIndex)) {
+        return false;
+    }
+
+    tileMap.place(TileLayer::Arrow, arrowIndex);
+    addArrow(tileMap.position(arrowIndex), direction);
+    LOG_DEBUG("Dispenser at ("
+        + std::to_string(posTile.x) + ", " + std::to_string(posTile.y)
+        + ") dispensed an Arrow.");
+    return true;
+}
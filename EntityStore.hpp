@@ -0,0 +1,89 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "Types.hpp"
+#include "Pattern.hpp"
+#include "Astar.hpp"
+#include "DistanceField.hpp"
+#include "ProjectilePool.hpp"
+#include "TileGrid.hpp"
+#include "WallRays.hpp"
+#include <cstdint>
+#include <vector>
+
+// Kinds of entities that act every step.
+// Walls and goals never act, so they only exist as symbols in the tile map.
+enum class EntityKind : std::uint8_t {
+    TraceMonster,
+    GuardMonster,
+    Dispenser,
+};
+
+// Entities driven by a compiled pattern (guard monsters and dispensers), one array per field
+struct PatternedEntities {
+    std::vector<sf::Vector2i> positions;
+    std::vector<CompiledPattern> patterns;
+    // Index of the next step in each pattern
+    std::vector<int> cursors;
+
+    int size() const;
+    void add(sf::Vector2i position, CompiledPattern pattern);
+    // Whether entity i has any step to follow
+    bool hasPattern(int i) const;
+    // Step at the cursor of entity i (only valid if hasPattern(i))
+    char currentStep(int i) const;
+    // Move to the next step, wrapping around at the end of the pattern
+    void advanceCursor(int i);
+    void setCursor(int i, int cursor);
+};
+
+// Monster or dispenser, as an index into the array of its kind
+struct ActorRef {
+    EntityKind kind;
+    int index;
+};
+
+// Every entity of a stage that can change, stored by kind in contiguous arrays.
+// Each update phase walks exactly the arrays it needs, no virtual calls or casts.
+class EntityStore {
+public:
+    std::vector<sf::Vector2i> traceMonsters;
+    PatternedEntities guardMonsters;
+    PatternedEntities dispensers;
+
+    // Flying arrows, recycled through a pool so steady arrow traffic never allocates
+    ProjectilePool arrows;
+
+    // Monsters and dispensers in stage order, which is also the order they act in.
+    // A monster may block the next one, so this order is part of the game rules.
+    std::vector<ActorRef> actors;
+
+    void addTraceMonster(sf::Vector2i position);
+    void addGuardMonster(sf::Vector2i position, CompiledPattern pattern);
+    void addDispenser(sf::Vector2i position, CompiledPattern pattern);
+    ProjectileHandle addArrow(sf::Vector2i position, char direction);
+    void clearArrows();
+
+    int actorCount() const;
+    int arrowCount() const;
+
+    // Put every monster and arrow on the occupancy layers of tileMap, or take them off again
+    void placeAll(TileGrid& tileMap) const;
+    void liftAll(TileGrid& tileMap) const;
+
+    // State of actor number `actor` in stage order (cursor is 0 for trace monsters)
+    char getActorSymbol(int actor) const;
+    sf::Vector2i getActorPosition(int actor) const;
+    int getActorCursor(int actor) const;
+    void setActorState(int actor, sf::Vector2i position, int cursor);
+
+    // Move arrow i one tile forward
+    // Returns false if it was blocked by a wall, a dispenser or the map edge: it is lifted off the map
+    // and the caller drops it. Whether it is blocked is read from the stage's wall rays
+    bool moveArrow(int i, TileGrid& tileMap, const WallRays& wallRays);
+    // Step trace monster i along the player distance field; where several neighbors are equally close,
+    // pathfinder breaks the tie the way the A* search always has
+    void updateTraceMonster(int i, TileGrid& tileMap, const DistanceField& playerDistance, Pathfinder& pathfinder);
+    void updateGuardMonster(int i, TileGrid& tileMap);
+    // Returns true if an arrow was spawned (spawned into the arrow pool)
+    bool updateDispenser(int i, TileGrid& tileMap);
+};
@@ -0,0 +1,127 @@
+#include "FrontierStore.hpp"
+#include <cstring>
+
+namespace {
+    // hash, player x and y, entity count
+    constexpr std::size_t HEADER_BYTES = 8 + 2 + 2 + 4;
+
+    // The spill file can outgrow what a long offset reaches on Windows
+    bool seekTo(std::FILE* file, std::uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+}
+
+FrontierStore::~FrontierStore() {
+    if(spillFile) std::fclose(spillFile);
+}
+
+// The file only lives as long as the search, so states are stored in the machine's own byte order
+void FrontierStore::append(std::vector<std::uint8_t>& bytes, const WorldState& state) {
+    std::uint32_t count = static_cast<std::uint32_t>(state.entities.size());
+    std::size_t offset = bytes.size();
+    bytes.resize(offset + HEADER_BYTES + count * sizeof(EntityState));
+    std::uint8_t* out = bytes.data() + offset;
+    std::memcpy(out, &state.hash, 8);
+    std::memcpy(out + 8, &state.playerX, 2);
+    std::memcpy(out + 10, &state.playerY, 2);
+    std::memcpy(out + 12, &count, 4);
+    if(count > 0) std::memcpy(out + HEADER_BYTES, state.entities.data(), count * sizeof(EntityState));
+}
+
+std::size_t FrontierStore::read(const std::vector<std::uint8_t>& bytes, std::size_t offset, WorldState& state) {
+    const std::uint8_t* in = bytes.data() + offset;
+    std::uint32_t count;
+    std::memcpy(&state.hash, in, 8);
+    std::memcpy(&state.playerX, in + 8, 2);
+    std::memcpy(&state.playerY, in + 10, 2);
+    std::memcpy(&count, in + 12, 4);
+    state.entities.resize(count);
+    if(count > 0) std::memcpy(state.entities.data(), in + HEADER_BYTES, count * sizeof(EntityState));
+    return offset + HEADER_BYTES + count * sizeof(EntityState);
+}
+
+void FrontierStore::setMemoryBudget(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudget = bytes;
+}
+
+bool FrontierStore::spill(Block& block) {
+    if(spillFailed) return false;
+    if(!spillFile) {
+        spillFile = std::tmpfile();
+        if(!spillFile) {
+            // Going over the budget beats losing states
+            std::fprintf(stderr, "Cannot create a spill file, the frontier stays in memory\n");
+            spillFailed = true;
+            return false;
+        }
+    }
+    if(!seekTo(spillFile, writtenBytes) || std::fwrite(block.bytes.data(), 1, block.bytes.size(), spillFile) != block.bytes.size()) {
+        std::fprintf(stderr, "Cannot write to the spill file, the frontier stays in memory\n");
+        spillFailed = true;
+        return false;
+    }
+    block.spilled = true;
+    block.fileOffset = writtenBytes;
+    block.fileSize = block.bytes.size();
+    writtenBytes += block.bytes.size();
+    return true;
+}
+
+void FrontierStore::addBlock(std::vector<std::uint8_t>& bytes, std::size_t stateCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    blocks.emplace_back();
+    Block& block = blocks.back();
+    block.bytes.swap(bytes);
+    block.stateCount = stateCount;
+    states += stateCount;
+
+    if(heldBytes + block.bytes.size() > memoryBudget && spill(block)) {
+        // Hand the buffer back for the caller to fill again
+        block.bytes.clear();
+        bytes.swap(block.bytes);
+        return;
+    }
+    heldBytes += block.bytes.size();
+}
+
+bool FrontierStore::takeBlock(std::size_t i, std::vector<std::uint8_t>& bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Block& block = blocks[i];
+    if(!block.spilled) {
+        heldBytes -= block.bytes.size();
+        bytes.swap(block.bytes);
+        std::vector<std::uint8_t>().swap(block.bytes);
+        return true;
+    }
+    bytes.resize(block.fileSize);
+    if(!seekTo(spillFile, block.fileOffset) || std::fread(bytes.data(), 1, block.fileSize, spillFile) != block.fileSize) {
+        std::fprintf(stderr, "Cannot read block %zu back from the spill file\n", i);
+        return false;
+    }
+    return true;
+}
+
+std::size_t FrontierStore::blockCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return blocks.size();
+}
+
+std::size_t FrontierStore::stateCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return states;
+}
+
+std::size_t FrontierStore::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return heldBytes;
+}
+
+std::size_t FrontierStore::spilledBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writtenBytes;
+}
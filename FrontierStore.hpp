@@ -0,0 +1,67 @@
+#pragma once
+#include "WorldState.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// One depth of a breadth-first search: WorldStates serialized back to back into blocks.
+//
+// Blocks are filled by the search threads on their own and handed over whole, so adding
+// states needs no locking. While the blocks fit the memory budget they stay in memory, the
+// rest are written to a temporary file and read back when their turn comes. Every block is
+// taken exactly once, which frees it.
+class FrontierStore {
+public:
+    // Size a block is handed over at, small enough to share a depth out between threads
+    static constexpr std::size_t BLOCK_BYTES = 64 * 1024;
+
+    FrontierStore() = default;
+    ~FrontierStore();
+    // The spill file is owned by exactly one object
+    FrontierStore(const FrontierStore&) = delete;
+    FrontierStore& operator=(const FrontierStore&) = delete;
+
+    // Write state to the end of bytes
+    static void append(std::vector<std::uint8_t>& bytes, const WorldState& state);
+    // Read the state starting at offset into state, returns the offset of the next one
+    static std::size_t read(const std::vector<std::uint8_t>& bytes, std::size_t offset, WorldState& state);
+
+    // Bytes of blocks that may stay in memory, later blocks are spilled
+    void setMemoryBudget(std::size_t bytes);
+    // Take the contents of bytes as a new block of stateCount states, bytes is left empty
+    // Safe to call from several threads
+    void addBlock(std::vector<std::uint8_t>& bytes, std::size_t stateCount);
+    // Move block i into bytes, from memory or from the spill file
+    // Safe to call from several threads; returns false if the block cannot be read back
+    bool takeBlock(std::size_t i, std::vector<std::uint8_t>& bytes);
+
+    std::size_t blockCount() const;
+    std::size_t stateCount() const;
+    // Bytes of blocks held in memory right now
+    std::size_t memoryBytes() const;
+    // Bytes of blocks written to the spill file so far
+    std::size_t spilledBytes() const;
+
+private:
+    struct Block {
+        std::vector<std::uint8_t> bytes;
+        std::size_t stateCount = 0;
+        bool spilled = false;
+        std::uint64_t fileOffset = 0;
+        std::size_t fileSize = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Block> blocks;
+    std::size_t states = 0;
+    std::size_t memoryBudget = static_cast<std::size_t>(-1);
+    std::size_t heldBytes = 0;
+    std::size_t writtenBytes = 0;
+    // Created on the first spill, removed by the system when closed
+    std::FILE* spillFile = nullptr;
+    bool spillFailed = false;
+
+    bool spill(Block& block);
+};
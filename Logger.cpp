@@ -1,14 +1,113 @@
 #include "Logger.hpp"
-#include "Constants.hpp"
 #include <iostream>
 #include <fstream>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // Longer messages are truncated to fit one slot
+    const size_t MESSAGE_CAPACITY = 240;
+    // Must be a power of two
+    const size_t RING_CAPACITY = 16384;
+
+    struct Record {
+        // Sequence number of the slot (Vyukov bounded queue)
+        // == position: free for the producer claiming it, == position + 1: ready for the writer
+        std::atomic<size_t> sequence;
+        std::time_t time;
+        unsigned short length;
+        char message[MESSAGE_CAPACITY];
+    };
+
+    // Multi-producer single-consumer bounded ring buffer
+    // Producers claim a position with one CAS and never wait for each other or the writer
+    class LogRing {
+    private:
+        std::unique_ptr<Record[]> records;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) size_t dequeuePos = 0;
+
+    public:
+        LogRing() : records(new Record[RING_CAPACITY]) {
+            for(size_t i = 0; i < RING_CAPACITY; i++) {
+                records[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Returns false (without blocking) when the ring is full
+        bool push(std::time_t time, const std::string& message) {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Record* record;
+            while(true) {
+                record = &records[pos & (RING_CAPACITY - 1)];
+                size_t sequence = record->sequence.load(std::memory_order_acquire);
+                if(sequence == pos) {
+                    if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if(sequence < pos) {
+                    return false; // Full: the writer has not freed this slot yet
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            size_t length = message.size() < MESSAGE_CAPACITY ? message.size() : MESSAGE_CAPACITY;
+            std::memcpy(record->message, message.data(), length);
+            record->length = static_cast<unsigned short>(length);
+            record->time = time;
+            record->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Only called by the writer thread
+        const Record* front() {
+            Record* record = &records[dequeuePos & (RING_CAPACITY - 1)];
+            if(record->sequence.load(std::memory_order_acquire) != dequeuePos + 1) return nullptr;
+            return record;
+        }
+
+        void pop() {
+            Record* record = &records[dequeuePos & (RING_CAPACITY - 1)];
+            record->sequence.store(dequeuePos + RING_CAPACITY, std::memory_order_release);
+            dequeuePos++;
+        }
+    };
+
+    LogRing ring;
+
+    // The writer blocks on this while the ring is empty instead of polling it.
+    // It raises writerAsleep before its last look at the ring, so a producer that pushes after
+    // that look sees the flag and wakes it; only that one producer pays for the notify.
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::atomic<bool> writerAsleep{false};
+
+    void wakeWriter() {
+        if(!writerAsleep.exchange(false)) return;
+        // Taking the lock orders this with the writer's check, so the notify cannot be missed
+        { std::lock_guard<std::mutex> lock(writerMutex); }
+        writerWake.notify_one();
+    }
+
+    // Format like "[2025-01-31 12:34:56] "
+    void appendTime(std::string& out, std::time_t time) {
+        char buffer[32];
+        std::tm localTime = *std::localtime(&time);
+        size_t length = std::strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S] ", &localTime);
+        out.append(buffer, length);
+    }
+}
 
 // Initialize static members
 std::ofstream Logger::logFile;
-bool Logger::initialized = false;
+std::atomic<bool> Logger::initialized{false};
+std::atomic<bool> Logger::running{false};
+std::atomic<size_t> Logger::droppedCount{0};
+std::atomic<size_t> Logger::activeProducers{0};
+std::thread Logger::writer;
 
 void Logger::init(const std::string& filename) {
     if(initialized) return;
@@ -17,6 +116,8 @@ void Logger::init(const std::string& filename) {
     logFile.open(filename, std::ios::trunc);
     
     if(logFile.is_open()) {
+        running = true;
+        writer = std::thread(writerLoop);
         initialized = true;
         log("--- Logger Initialized ---");
     } else {
@@ -27,33 +128,81 @@ void Logger::init(const std::string& filename) {
 void Logger::shutdown() {
     if(initialized && logFile.is_open()){
         log("--- Logger Shutdown ---");
-        logFile.close();
         initialized = false;
+        // A producer that saw initialized before it was cleared may still be pushing.
+        // Every producer is counted before it checks the flag, so once the count is zero
+        // the rest see it cleared and nothing more can reach the ring
+        while(activeProducers.load() != 0) std::this_thread::yield();
+
+        // The writer drains everything still queued before it exits
+        {
+            std::lock_guard<std::mutex> lock(writerMutex);
+            running = false;
+        }
+        writerWake.notify_one();
+        if(writer.joinable()) writer.join();
+
+        if(droppedCount > 0) {
+            logFile << "[Logger] " << droppedCount << " messages dropped (ring buffer full)\n";
+        }
+        logFile.close();
     }
 }
 
-std::string Logger::getCurrentTime() {
-    // Use chrono to get current time
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    
-    // Use put_time to format the time
-    std::stringstream ss;
-    ss << "[" << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S") << "] ";
-    return ss.str();
+void Logger::writerLoop() {
+    std::string batch;
+    batch.reserve(RING_CAPACITY * 64);
+    while(running) {
+        if(writeBatch(batch)) continue;
+
+        std::unique_lock<std::mutex> lock(writerMutex);
+        writerAsleep = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // A message pushed before the flag went up is still in the ring, write it first
+        if(ring.front() != nullptr) {
+            writerAsleep = false;
+            continue;
+        }
+        writerWake.wait(lock, [] { return !writerAsleep || !running; });
+        writerAsleep = false;
+    }
+    // Final drain after shutdown was requested
+    while(writeBatch(batch)) {}
+}
+
+bool Logger::writeBatch(std::string& batch) {
+    batch.clear();
+    const Record* record;
+    while((record = ring.front()) != nullptr) {
+        appendTime(batch, record->time);
+        batch.append(record->message, record->length);
+        batch += '\n';
+        ring.pop();
+    }
+    if(batch.empty()) return false;
+
+    // One write and one flush per batch instead of per line
+    logFile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    logFile.flush();
+    return true;
 }
 
 void Logger::log(const std::string& message) {
+    // Counted before initialized is read, see shutdown()
+    activeProducers.fetch_add(1);
     if(initialized) {
-        std::string timeStamp = getCurrentTime();
-        
-        // Write to log file
-        logFile << timeStamp << message << std::endl;
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if(ring.push(now, message)) {
+            // The push published the record before this reads the flag (both sequentially consistent)
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wakeWriter();
+        } else {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
     }
+    activeProducers.fetch_sub(1, std::memory_order_release);
 }
 
-void Logger::log_debug(const std::string& message) {
-    if(initialized && DEBUG_MODE) {
-        log(message);
-    }
-}
\ No newline at end of file
+size_t Logger::getDroppedCount() {
+    return droppedCount;
+}
@@ -1,28 +1,74 @@
 #pragma once
-#include "Constants.hpp"
+#include "Config.hpp"
 #include <string>
 #include <fstream>
+#include <atomic>
+#include <thread>
 
+// Severity of a log message, lowest first
+enum class LogLevel {
+    Debug = 0,
+    Info = 1,
+};
+
+// Levels below this are compiled out entirely, together with their argument expressions
+// (e.g. -DLOG_MIN_LEVEL=1 removes every LOG_DEBUG call site)
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// Leveled logging entry points. The message expression is only evaluated
+// when the level is compiled in and currently enabled, so disabled levels never build strings.
+#define LOG_AT_LEVEL(level, ...) \
+    do { \
+        if constexpr(static_cast<int>(level) >= LOG_MIN_LEVEL) { \
+            if(Logger::isEnabled(level)) Logger::log(__VA_ARGS__); \
+        } \
+    } while(0)
+#define LOG_DEBUG(...) LOG_AT_LEVEL(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT_LEVEL(LogLevel::Info, __VA_ARGS__)
+
+// Logging never writes on the calling thread.
+// log() copies the message into a fixed-size slot of a lock-free ring buffer,
+// and a background writer thread formats the timestamps and writes whole batches to the file.
+// When the ring is full the message is dropped and counted instead of blocking the game.
 class Logger {
 public:
     // Initialize the logging system (invoke at the start of main)
     static void init(const std::string& filename = "debug_log.txt");
 
     // Close the logging system (invoke at the end of main)
+    // Every message queued before this call is written out first
     static void shutdown();
 
     // Log a message with a timestamp
     static void log(const std::string& message);
-    // Log a debug message (only if DEBUG_MODE is true)
-    static void log_debug(const std::string& message);
+
+    // Runtime switch for the levels that are compiled in
+    // Debug messages follow Config::DEBUG_MODE, nothing is enabled before init()
+    static bool isEnabled(LogLevel level) {
+        if(!initialized.load(std::memory_order_relaxed)) return false;
+        return level != LogLevel::Debug || Config::DEBUG_MODE;
+    }
+
+    // Number of messages dropped because the ring buffer was full
+    static size_t getDroppedCount();
 
 private:
     static std::ofstream logFile;
-    static bool initialized;
+    static std::atomic<bool> initialized;
+    static std::atomic<bool> running;
+    static std::atomic<size_t> droppedCount;
+    // Calls to log() that may still push, shutdown waits for them before the final drain
+    static std::atomic<size_t> activeProducers;
+    static std::thread writer;
 
-    static std::string getCurrentTime();
+    // Background thread: drain the ring buffer and write batches until shutdown
+    static void writerLoop();
+    // Move every queued record into the file, returns false if there was none
+    static bool writeBatch(std::string& batch);
 
     // Hide constructors to prevent instantiation
     Logger() = delete;
     ~Logger() = delete;
-};
\ No newline at end of file
+};
@@ -0,0 +1,99 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    // Mapping an empty file fails, but it is still a valid (empty) file
+    if(fileSize.QuadPart == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(view == nullptr) {
+        close();
+        return false;
+    }
+    mappedData = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if(mappedData) UnmapViewOfFile(mappedData);
+    if(mappingHandle) CloseHandle(mappingHandle);
+    if(fileHandle) CloseHandle(fileHandle);
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+    if(fileDescriptor < 0) return false;
+
+    struct stat fileStat;
+    if(fstat(fileDescriptor, &fileStat) != 0) {
+        close();
+        return false;
+    }
+    // mmap rejects a length of 0, but it is still a valid (empty) file
+    if(fileStat.st_size == 0) return true;
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if(view == MAP_FAILED) {
+        close();
+        return false;
+    }
+    // The file is parsed front to back exactly once
+    madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+    mappedData = static_cast<const char*>(view);
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if(mappedData) munmap(const_cast<char*>(mappedData), mappedSize);
+    if(fileDescriptor >= 0) ::close(fileDescriptor);
+    mappedData = nullptr;
+    mappedSize = 0;
+    fileDescriptor = -1;
+}
+
+#endif
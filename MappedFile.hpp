@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file mapped into memory.
+// The contents are read straight from the page cache, nothing is copied into a buffer.
+class MappedFile {
+private:
+    const char* mappedData = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    // The mapping is owned by exactly one object
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file cannot be opened or mapped (an empty file maps to size 0)
+    bool open(const std::string& filename);
+    void close();
+
+    const char* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+};
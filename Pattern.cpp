@@ -0,0 +1,56 @@
+#include "Pattern.hpp"
+#include "Logger.hpp"
+#include <cctype>
+#include <string>
+
+// Process pattern: expand letters with numbers (e.g. U2D2L4 -> UUDDLLLL)
+std::string processPattern(const std::string& pattern) {
+    std::string expandedPattern;
+    for(size_t i = 0; i < pattern.size(); i++) {
+        char ch = pattern[i];
+        if(std::isalpha(ch)) {
+            // Check if followed by a digit
+            if(i + 1 < pattern.size() && std::isdigit(pattern[i + 1])) {
+                int repeatCount = pattern[i + 1] - '0';
+                // Handle multi-digit numbers
+                size_t j = i + 2;
+                while(j < pattern.size() && std::isdigit(pattern[j])) {
+                    repeatCount = repeatCount * 10 + (pattern[j] - '0');
+                    j++;
+                }
+                // Skip the digits
+                i = j - 1;
+                // Repeat the character
+                for(int k = 0; k < repeatCount; k++) {
+                    expandedPattern += ch;
+                }
+            } else {
+                // No number after letter, add once
+                expandedPattern += ch;
+            }
+        } else if(!std::isdigit(ch)) {
+            // Keep non-alphanumeric characters (like semicolons)
+            expandedPattern += ch;
+        }
+    }
+    
+    return expandedPattern;
+}
+
+// Remove leading and trailing spaces from a string
+std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(' ');
+    if (std::string::npos == first) return str;
+    size_t last = str.find_last_not_of(' ');
+    return str.substr(first, (last - first + 1));
+}
+
+// Compile an already expanded pattern (e.g. UUDDLLLL) into a shared step array
+CompiledPattern compilePattern(const std::string& pattern) {
+    if(pattern.empty()) {
+        LOG_DEBUG("Warning: Compiled an empty pattern string.");
+    } else {
+        LOG_DEBUG("Pattern compiled: " + pattern);
+    }
+    return std::make_shared<const std::vector<char>>(pattern.begin(), pattern.end());
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+// Behavior pattern compiled once at load time.
+// The steps never change, so every entity built from the same pattern shares one array
+// and only keeps an integer cursor into it.
+using CompiledPattern = std::shared_ptr<const std::vector<char>>;
+
+// Behavior pattern helpers used when loading and running stages
+std::string processPattern(const std::string& pattern);
+std::string trim(const std::string& str);
+CompiledPattern compilePattern(const std::string& pattern);
@@ -0,0 +1,113 @@
+#include "Profiler.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+bool Profiler::enabled = true;
+bool Profiler::capturing = false;
+std::array<Profiler::PhaseWindow, PROFILE_PHASE_COUNT> Profiler::windows;
+std::vector<Profiler::TraceEvent> Profiler::traceEvents;
+std::size_t Profiler::droppedEvents = 0;
+Profiler::Clock::time_point Profiler::captureStart;
+
+void Profiler::setEnabled(bool value) {
+    enabled = value;
+}
+
+void Profiler::record(ProfilePhase phase, Clock::time_point start, Clock::time_point end) {
+    std::int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    // Anything over 4 s is a hang, not a sample worth telling apart
+    std::uint32_t sample = static_cast<std::uint32_t>(std::min<std::int64_t>(duration, UINT32_MAX));
+
+    PhaseWindow& window = windows[static_cast<int>(phase)];
+    window.samples[window.next] = sample;
+    window.next = (window.next + 1) % WINDOW;
+    if(window.count < WINDOW) window.count++;
+    window.total++;
+    window.max = std::max(window.max, sample);
+
+    if(!capturing) return;
+    if(traceEvents.size() == MAX_TRACE_EVENTS) {
+        droppedEvents++;
+        return;
+    }
+    traceEvents.push_back({phase, std::chrono::duration_cast<std::chrono::nanoseconds>(start - captureStart).count(), duration});
+}
+
+const char* Profiler::phaseName(ProfilePhase phase) {
+    switch(phase) {
+        case ProfilePhase::Frame: return "Frame";
+        case ProfilePhase::Events: return "Events";
+        case ProfilePhase::Advance: return "Advance";
+        case ProfilePhase::Arrows: return "Arrows";
+        case ProfilePhase::Actors: return "Actors";
+        case ProfilePhase::PlayerAction: return "PlayerAction";
+        case ProfilePhase::Draw: return "Draw";
+        case ProfilePhase::Display: return "Display";
+    }
+    return "Unknown";
+}
+
+PhaseStats Profiler::getStats(ProfilePhase phase) {
+    const PhaseWindow& window = windows[static_cast<int>(phase)];
+    PhaseStats stats{phaseName(phase), window.count, 0.0, 0.0, window.max / 1000.0};
+    if(window.count == 0) return stats;
+
+    // Only the window is sorted, a few hundred values
+    std::array<std::uint32_t, WINDOW> sorted;
+    std::copy(window.samples.begin(), window.samples.begin() + window.count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + window.count);
+    stats.p50 = sorted[(window.count - 1) * 50 / 100] / 1000.0;
+    stats.p99 = sorted[(window.count - 1) * 99 / 100] / 1000.0;
+    return stats;
+}
+
+void Profiler::beginCapture() {
+    traceEvents.clear();
+    // Reserved up front so recording never allocates in the middle of a frame
+    traceEvents.reserve(MAX_TRACE_EVENTS);
+    droppedEvents = 0;
+    captureStart = Clock::now();
+    capturing = true;
+    LOG_INFO("Profiler capture started.");
+}
+
+bool Profiler::endCapture(const std::string& filename) {
+    capturing = false;
+    std::ofstream file(filename, std::ios::trunc);
+    if(!file.is_open()) {
+        LOG_INFO("Warning: Failed to write profiler trace to '" + filename + "'.");
+        return false;
+    }
+
+    // Chrome trace event format: complete ("X") events, timestamps in microseconds
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char buffer[160];
+    for(std::size_t i = 0; i < traceEvents.size(); i++) {
+        const TraceEvent& event = traceEvents[i];
+        std::snprintf(buffer, sizeof(buffer), "%s\n{\"name\":\"%s\",\"cat\":\"game\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+            i == 0 ? "" : ",", phaseName(event.phase), event.start / 1000.0, event.duration / 1000.0);
+        file << buffer;
+    }
+    file << "\n]}\n";
+
+    LOG_INFO("Profiler trace written to '" + filename + "': " + std::to_string(traceEvents.size()) + " events, "
+        + std::to_string(droppedEvents) + " dropped.");
+    // Give the reserved memory back, captures are rare
+    std::vector<TraceEvent>().swap(traceEvents);
+    return static_cast<bool>(file);
+}
+
+void Profiler::reportTotals() {
+    for(int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        ProfilePhase phase = static_cast<ProfilePhase>(i);
+        const PhaseWindow& window = windows[i];
+        if(window.total == 0) continue;
+        PhaseStats stats = getStats(phase);
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer), "Profile %-12s %8llu samples  p50 %9.1f us  p99 %9.1f us  max %9.1f us",
+            stats.name, static_cast<unsigned long long>(window.total), stats.p50, stats.p99, stats.max);
+        LOG_INFO(buffer);
+    }
+}
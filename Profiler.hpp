@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parts of a frame and of a turn that are timed
+enum class ProfilePhase : std::uint8_t {
+    // One main loop iteration, without the time spent sleeping for events
+    Frame,
+    Events,
+    // Stage::advance, the simulation phases below run inside it
+    Advance,
+    Arrows,
+    Actors,
+    PlayerAction,
+    Draw,
+    Display,
+};
+constexpr int PROFILE_PHASE_COUNT = 8;
+
+// Instrumentation is compiled out entirely with -DPROFILING=0 (the headless tools do)
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if PROFILING
+// Time the rest of the enclosing scope as phase
+#define PROFILE_SCOPE(phase) ProfileTimer PROFILE_CONCAT(profileTimer, __LINE__)(phase)
+#else
+#define PROFILE_SCOPE(phase) do {} while(0)
+#endif
+
+// p50 / p99 of the recent samples of a phase and its max since start, in microseconds
+struct PhaseStats {
+    const char* name;
+    int samples;
+    double p50;
+    double p99;
+    double max;
+};
+
+// Low-overhead phase timer for the main loop (main thread only).
+// Every timed scope adds its duration to a fixed rolling window per phase, so the overlay
+// always shows the recent distribution and nothing is allocated while playing.
+// While a capture is running each scope is also kept as a Chrome trace event,
+// written out as JSON that chrome://tracing or Perfetto can open to find hitches.
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Samples kept per phase for the percentiles
+    static constexpr int WINDOW = 256;
+    // Events kept per capture, later ones are dropped and counted
+    static constexpr std::size_t MAX_TRACE_EVENTS = 1 << 20;
+
+    // Runtime switch, a disabled profiler costs one branch per scope
+    static void setEnabled(bool value);
+    static bool isEnabled() { return enabled; }
+
+    static void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end);
+
+    static const char* phaseName(ProfilePhase phase);
+    static PhaseStats getStats(ProfilePhase phase);
+
+    // Start keeping trace events, and stop and write them to filename
+    // Returns false if the file could not be written
+    static void beginCapture();
+    static bool endCapture(const std::string& filename);
+    static bool isCapturing() { return capturing; }
+
+    // Log p50/p99/max of every phase (invoke at the end of main)
+    static void reportTotals();
+
+private:
+    struct PhaseWindow {
+        // Durations in nanoseconds, oldest overwritten first
+        std::array<std::uint32_t, WINDOW> samples{};
+        int next = 0;
+        int count = 0;
+        std::uint64_t total = 0;
+        std::uint32_t max = 0;
+    };
+
+    struct TraceEvent {
+        ProfilePhase phase;
+        // Nanoseconds since the capture started
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    static bool enabled;
+    static bool capturing;
+    static std::array<PhaseWindow, PROFILE_PHASE_COUNT> windows;
+    static std::vector<TraceEvent> traceEvents;
+    static std::size_t droppedEvents;
+    static Clock::time_point captureStart;
+
+    // Hide constructors to prevent instantiation
+    Profiler() = delete;
+    ~Profiler() = delete;
+};
+
+// Times its own lifetime as one sample of phase
+class ProfileTimer {
+private:
+    ProfilePhase phase;
+    Profiler::Clock::time_point start;
+    bool running;
+
+public:
+    explicit ProfileTimer(ProfilePhase phase) : phase(phase), running(Profiler::isEnabled()) {
+        if(running) start = Profiler::Clock::now();
+    }
+    ~ProfileTimer() { stop(); }
+    ProfileTimer(const ProfileTimer&) = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+    // End the sample before the scope does (only the first call counts)
+    void stop() {
+        if(!running) return;
+        running = false;
+        Profiler::record(phase, start, Profiler::Clock::now());
+    }
+    // Drop the sample, e.g. a loop iteration that turned out to have nothing to do
+    void cancel() { running = false; }
+};
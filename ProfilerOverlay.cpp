@@ -0,0 +1,42 @@
+#include "ProfilerOverlay.hpp"
+#include <cstdio>
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font) : text(font, "", 18) {
+    panel.setFillColor(sf::Color(0, 0, 0, 180));
+    panel.setPosition({10.f, 10.f});
+    text.setFillColor(sf::Color::White);
+    text.setPosition({20.f, 16.f});
+    content.reserve(128 * (PROFILE_PHASE_COUNT + 2));
+}
+
+void ProfilerOverlay::toggle() {
+    visible = !visible;
+}
+
+bool ProfilerOverlay::isVisible() const {
+    return visible;
+}
+
+void ProfilerOverlay::draw(sf::RenderWindow& window) {
+    if(!visible) return;
+
+    content = "Phase           p50 us     p99 us     max us";
+    char line[128];
+    for(int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        PhaseStats stats = Profiler::getStats(static_cast<ProfilePhase>(i));
+        std::snprintf(line, sizeof(line), "\n%-12s %9.1f  %9.1f  %9.1f", stats.name, stats.p50, stats.p99, stats.max);
+        content += line;
+    }
+    content += Profiler::isCapturing() ? "\n[F4] capturing trace..." : "\n[F4] capture trace";
+    text.setString(content);
+
+    sf::FloatRect bounds = text.getLocalBounds();
+    panel.setSize({bounds.size.x + 30.f, bounds.size.y + 30.f});
+
+    // Screen coordinates regardless of the stage view
+    sf::View previous = window.getView();
+    window.setView(window.getDefaultView());
+    window.draw(panel);
+    window.draw(text);
+    window.setView(previous);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Profiler.hpp"
+
+// On-screen table of the profiler phases (p50 / p99 / max), toggled with F3.
+// Drawn last in screen coordinates, on top of whatever the current screen shows.
+class ProfilerOverlay {
+private:
+    bool visible = false;
+    sf::RectangleShape panel;
+    sf::Text text;
+    // Reused every frame so redrawing the table does not allocate once it reached its size
+    std::string content;
+
+public:
+    explicit ProfilerOverlay(const sf::Font& font);
+
+    void toggle();
+    bool isVisible() const;
+
+    void draw(sf::RenderWindow& window);
+};
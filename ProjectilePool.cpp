@@ -0,0 +1,137 @@
+#include "Logger.hpp"
+#include "ProjectilePool.hpp"
+
+ProjectilePool::ProjectilePool(int capacity) {
+    reserve(capacity);
+}
+
+ProjectilePool::ProjectilePool(const ProjectilePool& other) {
+    *this = other;
+}
+
+ProjectilePool& ProjectilePool::operator=(const ProjectilePool& other) {
+    if(this == &other) return *this;
+
+    // Copying a vector only allocates for its elements, so the arrays that grow during play
+    // are reserved first and the copies then land in that storage
+    const std::size_t capacity = other.slotIndices.size();
+    positions.reserve(capacity);
+    directions.reserve(capacity);
+    denseSlots.reserve(capacity);
+    freeSlots.reserve(capacity);
+
+    positions = other.positions;
+    directions = other.directions;
+    denseSlots = other.denseSlots;
+    slotIndices = other.slotIndices;
+    slotGenerations = other.slotGenerations;
+    freeSlots = other.freeSlots;
+    return *this;
+}
+
+void ProjectilePool::growTo(int capacity) {
+    int oldCapacity = this->capacity();
+    if(capacity <= oldCapacity) return;
+
+    positions.reserve(capacity);
+    directions.reserve(capacity);
+    denseSlots.reserve(capacity);
+    slotIndices.resize(capacity, NO_INDEX);
+    slotGenerations.resize(capacity, 0);
+    freeSlots.reserve(capacity);
+
+    // Pushed in reverse so the lowest slot is handed out first
+    for(int slot = capacity - 1; slot >= oldCapacity; slot--) {
+        freeSlots.push_back(static_cast<std::uint32_t>(slot));
+    }
+}
+
+void ProjectilePool::reserve(int capacity) {
+    growTo(capacity);
+}
+
+int ProjectilePool::capacity() const {
+    return static_cast<int>(slotIndices.size());
+}
+
+int ProjectilePool::size() const {
+    return static_cast<int>(positions.size());
+}
+
+bool ProjectilePool::empty() const {
+    return positions.empty();
+}
+
+ProjectileHandle ProjectilePool::spawn(sf::Vector2i position, char direction) {
+    if(freeSlots.empty()) {
+        // Only happens when more projectiles fly at once than the pool was sized for
+        growTo(capacity() > 0 ? capacity() * 2 : 16);
+        LOG_INFO("Projectile pool grew to " + std::to_string(capacity()) + " slots.");
+    }
+
+    std::uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    slotIndices[slot] = static_cast<std::int32_t>(positions.size());
+    positions.push_back(position);
+    directions.push_back(direction);
+    denseSlots.push_back(slot);
+    return {slot, slotGenerations[slot]};
+}
+
+void ProjectilePool::removeAt(int i) {
+    std::uint32_t slot = denseSlots[i];
+    int last = size() - 1;
+
+    // Swap and pop: the last projectile fills the gap
+    if(i != last) {
+        positions[i] = positions[last];
+        directions[i] = directions[last];
+        denseSlots[i] = denseSlots[last];
+        slotIndices[denseSlots[i]] = i;
+    }
+    positions.pop_back();
+    directions.pop_back();
+    denseSlots.pop_back();
+
+    // Old handles to this slot no longer match
+    slotIndices[slot] = NO_INDEX;
+    slotGenerations[slot]++;
+    freeSlots.push_back(slot);
+}
+
+void ProjectilePool::remove(ProjectileHandle handle) {
+    int i = indexOf(handle);
+    if(i != NO_INDEX) removeAt(i);
+}
+
+void ProjectilePool::clear() {
+    for(std::uint32_t slot : denseSlots) {
+        slotIndices[slot] = NO_INDEX;
+        slotGenerations[slot]++;
+        freeSlots.push_back(slot);
+    }
+    positions.clear();
+    directions.clear();
+    denseSlots.clear();
+}
+
+bool ProjectilePool::isAlive(ProjectileHandle handle) const {
+    return indexOf(handle) != NO_INDEX;
+}
+
+int ProjectilePool::indexOf(ProjectileHandle handle) const {
+    if(handle.slot >= slotIndices.size() || slotGenerations[handle.slot] != handle.generation) return NO_INDEX;
+    return slotIndices[handle.slot];
+}
+
+ProjectileHandle ProjectilePool::handleAt(int i) const {
+    std::uint32_t slot = denseSlots[i];
+    return {slot, slotGenerations[slot]};
+}
+
+const std::vector<sf::Vector2i>& ProjectilePool::getPositions() const { return positions; }
+const std::vector<char>& ProjectilePool::getDirections() const { return directions; }
+sf::Vector2i ProjectilePool::getPosition(int i) const { return positions[i]; }
+void ProjectilePool::setPosition(int i, sf::Vector2i position) { positions[i] = position; }
+char ProjectilePool::getDirection(int i) const { return directions[i]; }
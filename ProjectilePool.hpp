@@ -0,0 +1,68 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <vector>
+
+// Stable reference to a pooled projectile.
+// Stays valid while the projectile flies, and never matches a later projectile reusing the slot.
+struct ProjectileHandle {
+    std::uint32_t slot = 0;
+    std::uint32_t generation = 0;
+};
+
+// Fixed-capacity store of flying projectiles.
+// Live projectiles are packed at the front of the arrays (no particular order) so a pass over them
+// is a linear scan; removal swaps the last one into the gap. Slots are recycled through a free list,
+// so once the capacity is reached spawning and removing never allocate.
+class ProjectilePool {
+private:
+    // Live projectiles, one array per field
+    std::vector<sf::Vector2i> positions;
+    std::vector<char> directions;
+    // Slot owning each live projectile
+    std::vector<std::uint32_t> denseSlots;
+
+    // Per slot: index into the arrays above while alive, and a generation bumped on every release
+    std::vector<std::int32_t> slotIndices;
+    std::vector<std::uint32_t> slotGenerations;
+    // Slots ready to be reused
+    std::vector<std::uint32_t> freeSlots;
+
+    // Add slots up to capacity (only allocates when the pool grows)
+    void growTo(int capacity);
+
+public:
+    static constexpr std::int32_t NO_INDEX = -1;
+
+    explicit ProjectilePool(int capacity = 0);
+    // A copy reserves the same capacity, so it does not allocate where the original would not
+    ProjectilePool(const ProjectilePool& other);
+    ProjectilePool& operator=(const ProjectilePool& other);
+    ProjectilePool(ProjectilePool&&) = default;
+    ProjectilePool& operator=(ProjectilePool&&) = default;
+
+    // Make room for at least capacity projectiles up front
+    void reserve(int capacity);
+    int capacity() const;
+    int size() const;
+    bool empty() const;
+
+    // Returns the handle of the new projectile, which is appended at index size() - 1
+    ProjectileHandle spawn(sf::Vector2i position, char direction);
+    // Remove the projectile at index i, the last one takes its place
+    void removeAt(int i);
+    void remove(ProjectileHandle handle);
+    // Remove every projectile, keeping the capacity
+    void clear();
+
+    bool isAlive(ProjectileHandle handle) const;
+    // Current index of a projectile, NO_INDEX once it is gone
+    int indexOf(ProjectileHandle handle) const;
+    ProjectileHandle handleAt(int i) const;
+
+    const std::vector<sf::Vector2i>& getPositions() const;
+    const std::vector<char>& getDirections() const;
+    sf::Vector2i getPosition(int i) const;
+    void setPosition(int i, sf::Vector2i position);
+    char getDirection(int i) const;
+};
@@ -0,0 +1,47 @@
+#include "RenderScheduler.hpp"
+#include "Logger.hpp"
+#include <string>
+
+const sf::Time RenderScheduler::IDLE_TIMEOUT = sf::milliseconds(500);
+const sf::Time RenderScheduler::REPORT_INTERVAL = sf::seconds(10);
+
+void RenderScheduler::invalidate() {
+    dirty = true;
+}
+
+bool RenderScheduler::needsRedraw() const {
+    return dirty;
+}
+
+std::optional<sf::Event> RenderScheduler::waitForEvent(sf::Window& window) {
+    if(dirty) return window.pollEvent();
+    return window.waitEvent(IDLE_TIMEOUT);
+}
+
+void RenderScheduler::frameDrawn() {
+    dirty = false;
+    activeFrames++;
+    totalActiveFrames++;
+    reportIfDue();
+}
+
+void RenderScheduler::frameSkipped() {
+    idleWakeups++;
+    totalIdleWakeups++;
+    reportIfDue();
+}
+
+void RenderScheduler::reportIfDue() {
+    if(reportClock.getElapsedTime() < REPORT_INTERVAL) return;
+
+    LOG_DEBUG("Frames in the last " + std::to_string(static_cast<int>(reportClock.getElapsedTime().asSeconds())) + " s: "
+        + std::to_string(activeFrames) + " active, " + std::to_string(idleWakeups) + " idle.");
+    activeFrames = 0;
+    idleWakeups = 0;
+    reportClock.restart();
+}
+
+void RenderScheduler::reportTotals() const {
+    LOG_INFO("Frames drawn: " + std::to_string(totalActiveFrames) + " active, "
+        + std::to_string(totalIdleWakeups) + " idle wake-ups.");
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <SFML/Window.hpp>
+#include <SFML/System.hpp>
+#include <optional>
+
+// Decides when the main loop has to redraw.
+// Anything that changes what is on screen calls invalidate(); while the scene is clean the loop
+// blocks in waitEvent instead of clearing, drawing and displaying the same frame again.
+class RenderScheduler {
+private:
+    // Something changed since the last frame was displayed
+    bool dirty = true;
+
+    // Frames actually drawn and loop wake-ups that drew nothing, since the last report
+    unsigned long activeFrames = 0;
+    unsigned long idleWakeups = 0;
+    // Totals since start
+    unsigned long totalActiveFrames = 0;
+    unsigned long totalIdleWakeups = 0;
+    sf::Clock reportClock;
+
+    void reportIfDue();
+
+public:
+    // Longest time the loop sleeps without any event
+    static const sf::Time IDLE_TIMEOUT;
+    // How often frame counts are written to the log
+    static const sf::Time REPORT_INTERVAL;
+
+    // Mark the scene as changed, the next loop iteration redraws it
+    void invalidate();
+    bool needsRedraw() const;
+
+    // First event of a loop iteration: returned immediately when a redraw is pending,
+    // otherwise waits for one (or the timeout)
+    std::optional<sf::Event> waitForEvent(sf::Window& window);
+
+    // Call once per loop iteration, after drawing if needsRedraw() was true
+    void frameDrawn();
+    void frameSkipped();
+
+    // Log the totals (invoke at the end of main)
+    void reportTotals() const;
+};
@@ -0,0 +1,243 @@
+#include "Replay.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace {
+    const char MAGIC[4] = {'S', 'L', 'R', 'P'};
+    const std::size_t HEADER_SIZE = 48;
+    // Versions 1 and 2 end before the history capacity
+    const std::size_t OLD_HEADER_SIZE = 44;
+
+    // Fixed little-endian encoding, so replays move between machines unchanged
+    void putInteger(std::vector<std::uint8_t>& out, std::uint64_t value, int bytes) {
+        for(int i = 0; i < bytes; i++) out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    std::uint64_t getInteger(const std::vector<std::uint8_t>& in, std::size_t& offset, int bytes) {
+        std::uint64_t value = 0;
+        for(int i = 0; i < bytes; i++) value |= static_cast<std::uint64_t>(in[offset + i]) << (8 * i);
+        offset += bytes;
+        return value;
+    }
+
+    // FNV-1a step
+    void mix(std::uint64_t& hash, std::uint64_t value) {
+        for(int i = 0; i < 8; i++) {
+            hash ^= (value >> (8 * i)) & 0xFF;
+            hash *= 0x100000001B3ULL;
+        }
+    }
+}
+
+
+
+// ========== Replay =============
+std::uint64_t Replay::fingerprint(const Simulation& simulation) {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    mix(hash, static_cast<std::uint64_t>(simulation.getColumn()));
+    mix(hash, static_cast<std::uint64_t>(simulation.getRow()));
+    mix(hash, static_cast<std::uint64_t>(simulation.getActionPerTurn()));
+    for(int y = 0; y < simulation.getRow(); y++) {
+        for(int x = 0; x < simulation.getColumn(); x++) {
+            mix(hash, static_cast<std::uint64_t>(simulation.getStaticTile(x, y)));
+        }
+    }
+    // Covers the player, monster and dispenser starts and their patterns' starting cursors
+    mix(hash, simulation.getHash());
+    return hash;
+}
+
+bool Replay::save(const std::string& filename) const {
+    std::vector<std::uint8_t> data;
+    data.reserve(HEADER_SIZE + (events.size() + 1) / 2);
+    data.insert(data.end(), MAGIC, MAGIC + 4);
+    putInteger(data, VERSION, 2);
+    putInteger(data, 0, 2);
+    putInteger(data, static_cast<std::uint32_t>(stageId), 4);
+    putInteger(data, seed, 8);
+    putInteger(data, stageFingerprint, 8);
+    putInteger(data, finalHash, 8);
+    putInteger(data, turnCount, 4);
+    putInteger(data, events.size(), 4);
+    putInteger(data, historyCapacity, 4);
+    for(std::size_t i = 0; i < events.size(); i += 2) {
+        std::uint8_t high = i + 1 < events.size() ? events[i + 1] : 0;
+        data.push_back(static_cast<std::uint8_t>(events[i] | (high << 4)));
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) {
+        LOG_INFO("Warning: Failed to write replay '" + filename + "'.");
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    LOG_INFO("Replay of stage " + std::to_string(stageId) + " saved to '" + filename + "': "
+        + std::to_string(turnCount) + " turns, " + std::to_string(events.size()) + " events.");
+    return static_cast<bool>(file);
+}
+
+bool Replay::load(const std::string& filename, std::string& error) {
+    std::ifstream file(filename, std::ios::binary);
+    if(!file.is_open()) {
+        error = "cannot open file";
+        return false;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if(data.size() < OLD_HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, data.begin())) {
+        error = "not a replay file";
+        return false;
+    }
+    std::size_t offset = 4;
+    std::uint64_t version = getInteger(data, offset, 2);
+    if(version == 0 || version > VERSION) {
+        error = "unsupported replay version " + std::to_string(version);
+        return false;
+    }
+    getInteger(data, offset, 2);
+    stageId = static_cast<std::int32_t>(getInteger(data, offset, 4));
+    seed = getInteger(data, offset, 8);
+    stageFingerprint = getInteger(data, offset, 8);
+    finalHash = getInteger(data, offset, 8);
+    turnCount = static_cast<std::uint32_t>(getInteger(data, offset, 4));
+    std::size_t eventCount = getInteger(data, offset, 4);
+    std::size_t headerSize = version >= 3 ? HEADER_SIZE : OLD_HEADER_SIZE;
+    if(data.size() < headerSize || data.size() - headerSize < (eventCount + 1) / 2) {
+        error = "replay is truncated";
+        return false;
+    }
+    historyCapacity = StateHistory::DEFAULT_CAPACITY;
+    if(version >= 3) {
+        historyCapacity = static_cast<std::uint32_t>(getInteger(data, offset, 4));
+        if(historyCapacity == 0 || historyCapacity > static_cast<std::uint32_t>(std::numeric_limits<int>::max())) {
+            error = "invalid history capacity " + std::to_string(historyCapacity);
+            return false;
+        }
+    }
+
+    events.resize(eventCount);
+    for(std::size_t i = 0; i < eventCount; i++) {
+        std::uint8_t packed = data[headerSize + i / 2];
+        events[i] = i % 2 == 0 ? (packed & 0x0F) : (packed >> 4);
+        if(events[i] > EVENT_REWIND) {
+            error = "unknown event " + std::to_string(events[i]) + " at " + std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// ========== ReplayRecorder =============
+void ReplayRecorder::begin(const Simulation& simulation, int historyCapacity) {
+    replay = Replay();
+    replay.stageId = simulation.getStageId();
+    replay.historyCapacity = static_cast<std::uint32_t>(historyCapacity);
+    replay.stageFingerprint = Replay::fingerprint(simulation);
+    replay.finalHash = simulation.getHash();
+}
+
+void ReplayRecorder::recordAction(Action action) {
+    replay.events.push_back(static_cast<std::uint8_t>(action));
+}
+
+void ReplayRecorder::recordUndo() {
+    replay.events.push_back(Replay::EVENT_UNDO);
+}
+
+void ReplayRecorder::recordAdvance(const Simulation& simulation) {
+    replay.events.push_back(Replay::EVENT_ADVANCE);
+    replay.turnCount++;
+    replay.finalHash = simulation.getHash();
+}
+
+void ReplayRecorder::recordReset(const Simulation& simulation) {
+    replay.events.push_back(Replay::EVENT_RESET);
+    replay.finalHash = simulation.getHash();
+}
+
+void ReplayRecorder::recordRewind(const Simulation& simulation, int turns) {
+    replay.events.insert(replay.events.end(), turns, Replay::EVENT_REWIND);
+    replay.finalHash = simulation.getHash();
+}
+
+const Replay& ReplayRecorder::getReplay() const {
+    return replay;
+}
+
+bool ReplayRecorder::empty() const {
+    return replay.events.empty();
+}
+
+
+
+// ========== ReplayPlayer =============
+ReplayPlayer::ReplayPlayer(const Replay& replay) :
+    replay(replay), history(static_cast<int>(replay.historyCapacity)) {
+    tracksHistory = std::find(replay.events.begin(), replay.events.end(), Replay::EVENT_REWIND) != replay.events.end();
+}
+
+bool ReplayPlayer::finished() const {
+    return position >= replay.events.size();
+}
+
+std::uint32_t ReplayPlayer::getTurnsPlayed() const {
+    return turnsPlayed;
+}
+
+bool ReplayPlayer::hasFailedRewind() const {
+    return rewindFailed;
+}
+
+TurnResult ReplayPlayer::playTurn(Simulation& simulation) {
+    if(!started) {
+        started = true;
+        if(tracksHistory) history.reset(simulation.saveState());
+    }
+
+    while(position < replay.events.size()) {
+        std::uint8_t event = replay.events[position++];
+        switch(event) {
+            case Replay::EVENT_UNDO:
+                simulation.undoLastAction();
+                break;
+            case Replay::EVENT_RESET:
+                simulation.reset();
+                if(tracksHistory) history.push(simulation.saveState());
+                break;
+            case Replay::EVENT_REWIND: {
+                // The recorder only keeps rewinds that succeeded, so one that fails here
+                // means the history differs from the recording; nothing after it can match
+                WorldState state;
+                if(!history.rewind(1, state)) {
+                    LOG_INFO("Warning: Replay rewinds past the " + std::to_string(history.size())
+                        + " turns kept at event " + std::to_string(position - 1) + ", playback stopped.");
+                    rewindFailed = true;
+                    position = replay.events.size();
+                    return TurnResult::Continue;
+                }
+                simulation.restoreState(state);
+                break;
+            }
+            case Replay::EVENT_ADVANCE: {
+                turnsPlayed++;
+                TurnResult result = simulation.advance();
+                if(tracksHistory) history.push(simulation.saveState());
+                return result;
+            }
+            default:
+                simulation.addAction(static_cast<Action>(event));
+                break;
+        }
+    }
+    return TurnResult::Continue;
+}
+
+bool ReplayPlayer::playAll(Simulation& simulation) {
+    while(!finished()) playTurn(simulation);
+    return !rewindFailed && turnsPlayed == replay.turnCount && simulation.getHash() == replay.finalHash;
+}
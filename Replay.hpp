@@ -0,0 +1,104 @@
+#pragma once
+#include "Types.hpp"
+#include "Simulation.hpp"
+#include "StateHistory.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Input recording of one stage, enough to re-simulate it exactly.
+//
+// The simulation is deterministic, so a replay only stores what the player did: every queued
+// action, every undo, every turn advance, reset and rewound turn, in order, starting from the stage as
+// loaded. On disk each event takes 4 bits behind a fixed 48-byte little-endian header:
+//   "SLRP", version (u16), flags (u16), stage id (i32), seed (u64), stage fingerprint (u64),
+//   final hash (u64), turn count (u32), event count (u32), history capacity (u32),
+//   events (two per byte, low nibble first)
+// Versions 1 and 2 have no history capacity field, their header is 44 bytes
+class Replay {
+public:
+    // Event codes, the Action values come first so an action is stored as itself
+    static constexpr std::uint8_t EVENT_UNDO = 6;
+    static constexpr std::uint8_t EVENT_ADVANCE = 7;
+    static constexpr std::uint8_t EVENT_RESET = 8;
+    // One turn taken back through the stage's StateHistory (version 2)
+    static constexpr std::uint8_t EVENT_REWIND = 9;
+    static constexpr std::uint16_t VERSION = 3;
+
+    int stageId = 0;
+    // Seed of any randomness the stage uses; the simulation has none, so it is always 0 for now
+    std::uint64_t seed = 0;
+    // Identifies the stage layout the replay was recorded on (see fingerprint())
+    std::uint64_t stageFingerprint = 0;
+    // State hash after the last recorded event, what a correct playback must end on
+    std::uint64_t finalHash = 0;
+    std::uint32_t turnCount = 0;
+    // Turns the stage's StateHistory kept, playback rewinds through one of the same size
+    // (version 3, older replays were all recorded with the default)
+    std::uint32_t historyCapacity = StateHistory::DEFAULT_CAPACITY;
+    // One event code per entry (unpacked in memory)
+    std::vector<std::uint8_t> events;
+
+    // Hash of everything about a stage a replay depends on: size, actions per turn, tiles and
+    // the starting state. Call it on a freshly loaded (or reset) stage
+    static std::uint64_t fingerprint(const Simulation& simulation);
+
+    // Returns false if the file cannot be written, or read and understood (error says why)
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, std::string& error);
+};
+
+// Collects the events of a stage as they happen. Stage feeds it from addAction, undoLastAction,
+// advance and reset; nothing is allocated per event beyond the growing event array.
+class ReplayRecorder {
+private:
+    Replay replay;
+
+public:
+    // Start a new recording on a stage in its initial state, rewinding through a history of historyCapacity turns
+    void begin(const Simulation& simulation, int historyCapacity = StateHistory::DEFAULT_CAPACITY);
+
+    void recordAction(Action action);
+    void recordUndo();
+    // After the advance or reset was applied, so the final hash follows the simulation
+    void recordAdvance(const Simulation& simulation);
+    void recordReset(const Simulation& simulation);
+    // Only rewinds the history allowed; a rejected one changes nothing and is not an event
+    void recordRewind(const Simulation& simulation, int turns);
+
+    const Replay& getReplay() const;
+    bool empty() const;
+};
+
+// Applies a replay to a simulation, a turn at a time or all at once.
+// The simulation must be the recorded stage in its initial state.
+class ReplayPlayer {
+private:
+    const Replay& replay;
+    std::size_t position = 0;
+    std::uint32_t turnsPlayed = 0;
+    // Turn history as Stage keeps it, only followed when the replay rewinds at all
+    bool tracksHistory = false;
+    bool started = false;
+    // A recorded rewind reached past the history, so the playback has left the recording
+    bool rewindFailed = false;
+    StateHistory history;
+
+public:
+    explicit ReplayPlayer(const Replay& replay);
+
+    bool finished() const;
+    std::uint32_t getTurnsPlayed() const;
+    // Whether playback stopped early because a recorded rewind could not be repeated
+    bool hasFailedRewind() const;
+
+    // Apply events up to and including the next turn advance
+    // Returns the result of that turn, or Continue if the replay ended without one
+    // A rewind that fails ends the playback there (see hasFailedRewind())
+    TurnResult playTurn(Simulation& simulation);
+    // Run to the end as fast as possible
+    // Returns true if every rewind succeeded and the simulation ends on the recorded state
+    // after the recorded number of turns
+    bool playAll(Simulation& simulation);
+};
@@ -0,0 +1,196 @@
+// Replay checker.
+// Re-simulates a recorded replay against the stage file, as fast as possible by default or one
+// turn at a time with the board printed, and reports whether it ends on the recorded state.
+// Can also record a replay of random input, to test and time playback.
+//
+// Usage: replay FILE [--stages STAGE_FILE] [--watch MS]
+//        replay --record FILE --stage ID --turns N [--stages STAGE_FILE] [--seed S]
+#include "Types.hpp"
+#include "Simulation.hpp"
+#include "Replay.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void printBoard(const Simulation& simulation, std::uint32_t turn) {
+    std::string board;
+    for(int y = 0; y < simulation.getRow(); y++) {
+        for(int x = 0; x < simulation.getColumn(); x++) {
+            sf::Vector2i tile{x, y};
+            board += tile == simulation.getPlayer().posTile ? SYMBOL_PLAYER : simulation.getTileSymbol(x, y);
+        }
+        board += '\n';
+    }
+    std::printf("\n-- turn %u --\n%s", turn, board.c_str());
+    std::fflush(stdout);
+}
+
+const Simulation* findStage(const std::vector<Simulation>& simulations, int stageId) {
+    for(const Simulation& simulation : simulations) {
+        if(simulation.getStageId() == stageId) return &simulation;
+    }
+    return nullptr;
+}
+
+// Same calls as the key handlers make through Stage, with random keys
+Replay recordRandom(const Simulation& stage, std::uint32_t turns, std::uint64_t seed) {
+    Simulation simulation = stage;
+    StateHistory history;
+    ReplayRecorder recorder;
+    recorder.begin(simulation, history.getCapacity());
+    history.reset(simulation.saveState());
+
+    std::uint64_t state = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    auto next = [&state](int bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((state >> 33) % static_cast<std::uint64_t>(bound));
+    };
+
+    for(std::uint32_t turn = 0; turn < turns; turn++) {
+        while(!simulation.reachMaxActions()) {
+            // Mostly moves, now and then a wait, an undo, a reset or a rewind
+            int roll = next(100);
+            WorldState rewound;
+            if(roll < 3) {
+                simulation.undoLastAction();
+                recorder.recordUndo();
+            } else if(roll < 4) {
+                simulation.reset();
+                recorder.recordReset(simulation);
+                history.push(simulation.saveState());
+            } else if(roll < 6) {
+                int rewindTurns = 1 + next(5);
+                if(history.rewind(rewindTurns, rewound)) {
+                    simulation.restoreState(rewound);
+                    recorder.recordRewind(simulation, rewindTurns);
+                }
+            } else {
+                Action action = roll < 14 ? Action::None : static_cast<Action>(next(4));
+                simulation.addAction(action);
+                recorder.recordAction(action);
+            }
+        }
+        TurnResult result = simulation.advance();
+        recorder.recordAdvance(simulation);
+        history.push(simulation.saveState());
+        // The clear screen offers a retry, take it
+        if(result == TurnResult::StageCleared) {
+            simulation.reset();
+            recorder.recordReset(simulation);
+            history.push(simulation.saveState());
+        }
+    }
+    return recorder.getReplay();
+}
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s FILE [--stages STAGE_FILE] [--watch MS]\n"
+        "       %s --record FILE --stage ID --turns N [--stages STAGE_FILE] [--seed S]\n", program, program);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string replayFile;
+    std::string stageFile = "stages.txt";
+    std::string recordFile;
+    int stageId = 1;
+    std::uint32_t turns = 1000;
+    std::uint64_t seed = 1;
+    int watchMs = -1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--stages" && hasValue) {
+            stageFile = argv[++i];
+        } else if(arg == "--watch" && hasValue) {
+            watchMs = std::atoi(argv[++i]);
+        } else if(arg == "--record" && hasValue) {
+            recordFile = argv[++i];
+        } else if(arg == "--stage" && hasValue) {
+            stageId = std::atoi(argv[++i]);
+        } else if(arg == "--turns" && hasValue) {
+            turns = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if(arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if(arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if(arg[0] != '-' && replayFile.empty()) {
+            replayFile = arg;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if(replayFile.empty() && recordFile.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Simulation> simulations;
+    Simulation::loadFromFile(stageFile, simulations);
+
+    if(!recordFile.empty()) {
+        const Simulation* stage = findStage(simulations, stageId);
+        if(!stage) {
+            std::fprintf(stderr, "Stage %d not found in %s\n", stageId, stageFile.c_str());
+            return 2;
+        }
+        Replay replay = recordRandom(*stage, turns, seed);
+        if(!replay.save(recordFile)) {
+            std::fprintf(stderr, "Cannot write %s\n", recordFile.c_str());
+            return 2;
+        }
+        std::printf("Recorded %u turns (%zu events) of stage %d to %s\n", replay.turnCount, replay.events.size(), stageId, recordFile.c_str());
+        return 0;
+    }
+
+    Replay replay;
+    std::string error;
+    if(!replay.load(replayFile, error)) {
+        std::fprintf(stderr, "%s: %s\n", replayFile.c_str(), error.c_str());
+        return 2;
+    }
+    const Simulation* stage = findStage(simulations, replay.stageId);
+    if(!stage) {
+        std::fprintf(stderr, "Stage %d of the replay is not in %s\n", replay.stageId, stageFile.c_str());
+        return 2;
+    }
+    if(Replay::fingerprint(*stage) != replay.stageFingerprint) {
+        std::fprintf(stderr, "Stage %d in %s is not the stage the replay was recorded on\n", replay.stageId, stageFile.c_str());
+        return 3;
+    }
+
+    Simulation simulation = *stage;
+    ReplayPlayer player(replay);
+    auto begin = std::chrono::steady_clock::now();
+    bool matches;
+    if(watchMs < 0) {
+        matches = player.playAll(simulation);
+    } else {
+        printBoard(simulation, 0);
+        while(!player.finished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(watchMs));
+            TurnResult result = player.playTurn(simulation);
+            printBoard(simulation, player.getTurnsPlayed());
+            if(result == TurnResult::PlayerDied) std::printf("(player died, stage reset)\n");
+            else if(result == TurnResult::StageCleared) std::printf("(stage cleared)\n");
+        }
+        matches = !player.hasFailedRewind() && player.getTurnsPlayed() == replay.turnCount && simulation.getHash() == replay.finalHash;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("Stage %d: %u turns, %zu events in %.2f ms: %s\n", replay.stageId, player.getTurnsPlayed(),
+        replay.events.size(), ms, matches ? "OK, final state matches"
+        : player.hasFailedRewind() ? "MISMATCH, a recorded rewind reaches past the history"
+        : "MISMATCH, final state differs from the recording");
+    return matches ? 0 : 1;
+}
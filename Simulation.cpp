@@ -0,0 +1,433 @@
+#include "Types.hpp"
+#include "Pattern.hpp"
+#include "Logger.hpp"
+#include "Simulation.hpp"
+#include "Object.hpp"
+#include "StageParser.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Start tile of the player, (0, 0) if the stage has none
+static sf::Vector2i findPlayerStart(const StageDefinition& definition) {
+    for(int r = 0; r < definition.row; r++) {
+        for(int c = 0; c < definition.column; c++) {
+            if(definition.tileAt(c, r) == SYMBOL_PLAYER) return {c, r};
+        }
+    }
+    LOG_INFO("Warning: Player symbol not found in stage " + std::to_string(definition.stageId) + ". Creating default player at (0,0).");
+    return {0, 0};
+}
+
+Simulation::Simulation(const StageDefinition& definition) :
+    stageId(definition.stageId), row(definition.row), column(definition.column), actionPerTurn(definition.actionPerTurn),
+    player(findPlayerStart(definition)) {
+    tileMap = TileGrid(column, row);
+
+    // Patterns are handed out to guard monsters and dispensers in map order
+    size_t guardMonsterCount = 0;
+    size_t dispenserCount = 0;
+    // Entities without a pattern of their own stand still
+    static const std::string NO_PATTERN;
+    // Each distinct pattern text is compiled once and its steps shared by every entity using it
+    std::unordered_map<std::string, CompiledPattern> compiledPatterns;
+    auto nextPattern = [&compiledPatterns](const std::vector<std::string>& patterns, size_t& count) {
+        const std::string& pattern = count < patterns.size() ? patterns[count] : NO_PATTERN;
+        count++;
+        CompiledPattern& compiled = compiledPatterns[pattern];
+        if(!compiled) compiled = compilePattern(pattern);
+        return compiled;
+    };
+
+    for(int r = 0; r < row; r++) {
+        for(int c = 0; c < column; c++) {
+            char ch = definition.tileAt(c, r);
+            // Walls, goals and dispensers become tiles, anything else leaves open space
+            tileMap.setTile(c, r, ch);
+
+            // Entity creation based on symbol
+            if(ch == SYMBOL_TRACE_MONSTER) {
+                entities.addTraceMonster({c, r});
+            } else if(ch == SYMBOL_GUARD_MONSTER) {
+                entities.addGuardMonster({c, r}, nextPattern(definition.guardMonsterPatterns, guardMonsterCount));
+            } else if(ch == SYMBOL_DISPENSER) {
+                entities.addDispenser({c, r}, nextPattern(definition.dispenserPatterns, dispenserCount));
+            }
+        }
+    }
+
+    entities.placeAll(tileMap);
+    wallRays = WallRays(tileMap);
+    trajectories = std::make_shared<const TrajectoryTable>(tileMap, entities);
+
+    // Every arrow stands on its own open tile in practice, so the map area is enough to never grow the pool
+    entities.arrows.reserve(row * column);
+
+    // Save initial state for reset
+    indexInitialState();
+
+    LOG_INFO("Total entities in stage " + std::to_string(stageId) + ": " + std::to_string(entities.actorCount()));
+    LOG_INFO("Stage " + std::to_string(stageId) + " created with size ("
+        + std::to_string(column) + ", " + std::to_string(row) + ").");
+    print();
+}
+
+void Simulation::loadFromFile(const std::string& filename, std::vector<Simulation>& simulations) {
+    std::vector<StageDefinition> definitions;
+    loadDefinitions(filename, definitions);
+    simulations.reserve(simulations.size() + definitions.size());
+    for(const StageDefinition& definition : definitions) {
+        simulations.emplace_back(definition);
+    }
+}
+
+bool Simulation::loadDefinitions(const std::string& filename, std::vector<StageDefinition>& definitions) {
+    std::vector<ParseDiagnostic> diagnostics;
+    bool valid = StageParser::parseFile(filename, definitions, diagnostics);
+
+    // Problems are reported with their position so the stage file can be fixed
+    for(const ParseDiagnostic& diagnostic : diagnostics) {
+        std::string text = StageParser::format(filename, diagnostic);
+        LOG_INFO(text);
+        std::cerr << text << std::endl;
+    }
+    LOG_INFO(std::to_string(definitions.size()) + " stages loaded from " + filename + ".");
+    return valid;
+}
+
+int Simulation::getStageId() const { return stageId; }
+int Simulation::getRow() const { return row; }
+int Simulation::getColumn() const { return column; }
+int Simulation::getActionPerTurn() const { return actionPerTurn; }
+const TileGrid& Simulation::getTileMap() const { return tileMap; }
+char Simulation::getStaticTile(int x, int y) const { return tileMap.at(x, y); }
+const EntityStore& Simulation::getEntities() const { return entities; }
+const Player& Simulation::getPlayer() const { return player; }
+const WallRays& Simulation::getWallRays() const { return wallRays; }
+
+bool Simulation::predictArrow(int arrow, int turns, sf::Vector2i& position) const {
+    const ProjectilePool& arrows = entities.arrows;
+    int index;
+    if(!wallRays.positionAt(tileMap.index(arrows.getPosition(arrow)), arrows.getDirection(arrow), turns, index)) return false;
+    position = tileMap.position(index);
+    return true;
+}
+
+bool Simulation::arrowWillReach(const sf::Vector2i& pos, int turns) const {
+    const ProjectilePool& arrows = entities.arrows;
+    const int target = tileMap.index(pos);
+    for(int i = 0; i < arrows.size(); i++) {
+        int index;
+        if(wallRays.positionAt(tileMap.index(arrows.getPosition(i)), arrows.getDirection(i), turns, index) && index == target) return true;
+    }
+    return false;
+}
+
+sf::Vector2i Simulation::predictGuardMonster(int guard, int turns) const {
+    const PatternedEntities& guardMonsters = entities.guardMonsters;
+    int index, cursor;
+    trajectories->guardStateAt(tileMap, guard, tileMap.index(guardMonsters.positions[guard]), guardMonsters.cursors[guard],
+        turns, index, cursor);
+    return tileMap.position(index);
+}
+
+char Simulation::predictDispenserShot(int dispenser, int turns) const {
+    return trajectories->dispenserShotAt(dispenser, entities.dispensers.cursors[dispenser], turns);
+}
+
+void Simulation::addAction(const Action action) {
+    actions.push_back(action);
+}
+
+bool Simulation::reachMaxActions() const {
+    return actions.size() >= static_cast<size_t>(actionPerTurn);
+}
+
+void Simulation::undoLastAction() {
+    if(actions.empty()) {
+        LOG_DEBUG("No actions to undo.");
+        return;
+    }
+
+    // Remove the last action added
+    actions.pop_back();
+
+    LOG_DEBUG("Last action undone. Remaining actions: " + std::to_string(actions.size()));
+}
+
+void Simulation::handleObjectAction() {
+    LOG_INFO("Handling object action.");
+
+    // Arrows fly first, then monsters and dispensers act
+    // Arrows spawned by dispensers only start flying on the next step
+    updateArrows();
+    updateActors();
+
+    LOG_DEBUG("Remaining arrows after handling actions: " + std::to_string(entities.arrowCount()));
+}
+
+void Simulation::updateArrows() {
+    PROFILE_SCOPE(ProfilePhase::Arrows);
+    ProjectilePool& arrows = entities.arrows;
+
+    // Arrows only collide with walls and dispensers and never hide each other on the occupancy layers,
+    // so the order they move in does not matter and a stopped arrow is swapped out in O(1)
+    for(int i = 0; i < arrows.size();) {
+        hash ^= arrowKey(i);
+        if(!entities.moveArrow(i, tileMap, wallRays)) {
+            // The last arrow now sits at i and has not moved yet
+            arrows.removeAt(i);
+            continue;
+        }
+        hash ^= arrowKey(i);
+        i++;
+    }
+}
+
+void Simulation::updateActors() {
+    PROFILE_SCOPE(ProfilePhase::Actors);
+    // One BFS from the player serves every TraceMonster in this step
+    if(!entities.traceMonsters.empty() && !playerDistance.isComputedFor(player.posTile)) {
+        playerDistance.compute(player.posTile, tileMap);
+    }
+
+    for(int actor = 0; actor < entities.actorCount(); actor++) {
+        const ActorRef& ref = entities.actors[actor];
+        std::uint64_t before = actorKey(actor);
+
+        switch(ref.kind) {
+            case EntityKind::TraceMonster:
+                entities.updateTraceMonster(ref.index, tileMap, playerDistance, pathfinder);
+                break;
+            case EntityKind::GuardMonster:
+                entities.updateGuardMonster(ref.index, tileMap);
+                break;
+            case EntityKind::Dispenser:
+                if(entities.updateDispenser(ref.index, tileMap)) {
+                    hash ^= arrowKey(entities.arrowCount() - 1);
+                }
+                break;
+        }
+
+        hash ^= before ^ actorKey(actor);
+    }
+}
+
+void Simulation::handlePlayerAction(Action action) {
+    PROFILE_SCOPE(ProfilePhase::PlayerAction);
+    LOG_INFO("Handling player action.");
+
+    switch(action) {
+        case Action::MoveUp:
+        case Action::MoveDown:
+        case Action::MoveLeft:
+        case Action::MoveRight: {
+            int oldIndex = tileIndex(player.posTile);
+            player.update(tileMap, action);
+            hash ^= Zobrist::playerKey(oldIndex) ^ Zobrist::playerKey(tileIndex(player.posTile));
+            break;
+        }
+        case Action::Attack:
+            // To be implemented
+            break;
+        case Action::None:
+            break;
+    }
+}
+
+bool Simulation::playerIsDead() {
+    // End position of player collides with any monster or projectile
+    if(tileMap.hasAny(TileGrid::DANGEROUS, player.posTile)) {
+        LOG_INFO("Player collided with a dangerous object at ("
+            + std::to_string(player.posTile.x) + ", " + std::to_string(player.posTile.y) + ").");
+        return true;
+    }
+
+    // Player bumps into any monster or projectile
+    // Temporary no need to check
+
+    return false;
+}
+
+bool Simulation::playerReachedGoal() {
+    // End position of player is on goal tile
+    if(tileMap.has(TileLayer::Goal, tileMap.index(player.posTile))) {
+        LOG_INFO("Player reached the goal at ("
+            + std::to_string(player.posTile.x) + ", " + std::to_string(player.posTile.y) + ").");
+        return true;
+    }
+
+    return false;
+}
+
+TurnResult Simulation::advance() {
+    LOG_INFO("Advancing stage by " + std::to_string(actionPerTurn) + " actions.");
+    for(int i = 0; i < actionPerTurn; i++) {
+        if(actions.empty()) {
+            LOG_DEBUG("No more actions to handle.");
+            break;
+        }
+        Action action = actions.front();
+        actions.pop_front();
+        TurnResult result = step(action);
+        if(result == TurnResult::PlayerDied) {
+            LOG_INFO("Player has died. Stopping stage advance. Starting reset.");
+            LOG_DEBUG("Stage state before reset:");
+            print();
+            reset();
+            return result;
+        }
+        if(result == TurnResult::StageCleared) {
+            LOG_INFO("Player has reached the goal! Stopping stage advance.");
+            return result;
+        }
+    }
+    LOG_DEBUG("Stage advanced.");
+    LOG_DEBUG("Stage state after advance:");
+    print();
+    return TurnResult::Continue;
+}
+
+TurnResult Simulation::step(Action action) {
+    handleObjectAction();
+    handlePlayerAction(action);
+    if(playerIsDead()) return TurnResult::PlayerDied;
+    if(playerReachedGoal()) return TurnResult::StageCleared;
+    return TurnResult::Continue;
+}
+
+int Simulation::tileIndex(const sf::Vector2i& pos) const {
+    return tileMap.index(pos);
+}
+
+std::uint64_t Simulation::actorKey(int actor) const {
+    return Zobrist::entityKey(actor, tileIndex(entities.getActorPosition(actor)), entities.getActorCursor(actor));
+}
+
+std::uint64_t Simulation::arrowKey(int arrow) const {
+    return Zobrist::arrowKey(entities.arrows.getDirection(arrow), tileIndex(entities.arrows.getPosition(arrow)));
+}
+
+std::uint64_t Simulation::computeHash() const {
+    // Tiles never change and the occupancy layers follow from the entities, so they need no keys
+    std::uint64_t key = Zobrist::playerKey(tileIndex(player.posTile));
+    for(int actor = 0; actor < entities.actorCount(); actor++) {
+        key ^= actorKey(actor);
+    }
+    for(int arrow = 0; arrow < entities.arrowCount(); arrow++) {
+        key ^= arrowKey(arrow);
+    }
+    return key;
+}
+
+void Simulation::indexInitialState() {
+    hash = computeHash();
+    initialState = saveState();
+}
+
+std::uint64_t Simulation::getHash() const {
+    return hash;
+}
+
+char Simulation::getTileSymbol(int x, int y) const {
+    int index = tileMap.index(x, y);
+    if(tileMap.has(TileLayer::Arrow, index)) return SYMBOL_ARROW;
+    if(tileMap.has(TileLayer::Monster, index)) {
+        // The layer does not tell monster kinds apart, look the monster up (only used for display)
+        for(const sf::Vector2i& position : entities.guardMonsters.positions) {
+            if(position == sf::Vector2i{x, y}) return SYMBOL_GUARD_MONSTER;
+        }
+        return SYMBOL_TRACE_MONSTER;
+    }
+    return tileMap[index];
+}
+
+WorldState Simulation::saveState() const {
+    WorldState state;
+    saveState(state);
+    return state;
+}
+
+void Simulation::saveState(WorldState& state) const {
+    state.hash = hash;
+    state.playerX = static_cast<std::int16_t>(player.posTile.x);
+    state.playerY = static_cast<std::int16_t>(player.posTile.y);
+
+    // Tiles never change and the occupancy layers follow from the entities, so the entities are the whole state
+    state.entities.clear();
+    state.entities.reserve(entities.actorCount() + entities.arrowCount());
+    for(int actor = 0; actor < entities.actorCount(); actor++) {
+        sf::Vector2i position = entities.getActorPosition(actor);
+        state.entities.push_back({static_cast<std::int16_t>(position.x), static_cast<std::int16_t>(position.y),
+            entities.getActorSymbol(actor), 0, static_cast<std::uint16_t>(entities.getActorCursor(actor))});
+    }
+    for(int arrow = 0; arrow < entities.arrowCount(); arrow++) {
+        sf::Vector2i position = entities.arrows.getPosition(arrow);
+        state.entities.push_back({static_cast<std::int16_t>(position.x), static_cast<std::int16_t>(position.y),
+            SYMBOL_ARROW, entities.arrows.getDirection(arrow), 0});
+    }
+    // The pool order depends on which arrows were removed before, so the same arrows are
+    // written by tile and direction: equal states then encode equally, as their hashes do
+    std::sort(state.entities.begin() + entities.actorCount(), state.entities.end(),
+        [](const EntityState& a, const EntityState& b) {
+            if(a.y != b.y) return a.y < b.y;
+            if(a.x != b.x) return a.x < b.x;
+            return a.direction < b.direction;
+        });
+}
+
+void Simulation::restoreState(const WorldState& state) {
+    actions.clear();
+
+    player.posTile = {state.playerX, state.playerY};
+
+    // Take the current monsters and arrows off the occupancy layers, then put the restored ones on
+    entities.liftAll(tileMap);
+
+    // Monsters and dispensers keep their identity, only their position and pattern cursor change
+    size_t e = 0;
+    for(int actor = 0; actor < entities.actorCount(); actor++) {
+        const EntityState& entity = state.entities[e++];
+        entities.setActorState(actor, {entity.x, entity.y}, entity.cursor);
+    }
+
+    // Arrows are refilled in their saved (sorted) order, reusing the pool's slots
+    entities.clearArrows();
+    for(; e < state.entities.size(); e++) {
+        const EntityState& entity = state.entities[e];
+        entities.addArrow({entity.x, entity.y}, entity.direction);
+    }
+
+    entities.placeAll(tileMap);
+    hash = state.hash;
+}
+
+void Simulation::print() const {
+    // The whole dump is debug output, skip building the lines when it would be discarded
+    if constexpr(static_cast<int>(LogLevel::Debug) < LOG_MIN_LEVEL) return;
+    if(!Logger::isEnabled(LogLevel::Debug)) return;
+
+    LOG_DEBUG("=====================");
+    LOG_DEBUG("Printing tile map for Stage " + std::to_string(stageId) + ":");
+    LOG_DEBUG("Size (" + std::to_string(column) + ", " + std::to_string(row) + "):");
+    LOG_DEBUG("Action Per Turn: " + std::to_string(actionPerTurn));
+    LOG_DEBUG("=====================");
+    for(int y = 0; y < row; y++) {
+        std::string line;
+        for(int x = 0; x < column; x++) {
+            line += getTileSymbol(x, y);
+        }
+        LOG_DEBUG(line);
+    }
+    LOG_DEBUG("=====================");
+}
+
+void Simulation::reset() {
+    LOG_INFO("Resetting stage " + std::to_string(stageId) + " to initial state.");
+
+    // Entities loaded from the stage are kept, only their state is copied back from the snapshot
+    // Spawned arrows are dropped and nothing is allocated or reconstructed
+    restoreState(initialState);
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "Types.hpp"
+#include "Logger.hpp"
+#include "Object.hpp"
+#include "EntityStore.hpp"
+#include "DistanceField.hpp"
+#include "WorldState.hpp"
+#include "TileGrid.hpp"
+#include "WallRays.hpp"
+#include "TrajectoryTable.hpp"
+#include "StageParser.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+#include <deque>
+
+// Outcome of advancing the simulation by one turn
+enum class TurnResult {
+    Continue,
+    PlayerDied,
+    StageCleared,
+};
+
+// Pure game logic of a stage: tile map, objects, turn advance and win/death checks.
+// It never touches textures or windows, so it can run headless (tests, solvers, servers).
+// Stage renders a Simulation by reading its state after each turn.
+class Simulation {
+private:
+    // Starts from 1
+    int stageId;
+    int row;
+    int column;
+    int actionPerTurn;
+
+    // Stage tiles inside a wall border, with the occupancy layers of monsters and arrows
+    TileGrid tileMap;
+    // Flight range of arrows from every tile, the walls and dispensers they stop at never move
+    WallRays wallRays;
+    // Future walks of guard monsters and shots of dispensers, shared read-only between copies
+    std::shared_ptr<const TrajectoryTable> trajectories;
+
+    // Monsters, dispensers and arrows, each kind in its own arrays
+    // Walls and goals only exist in the tile map
+    EntityStore entities;
+
+    Player player;
+    // Distances to the player, shared by all TraceMonsters
+    // Walls and dispensers never move, so it only changes when the player does
+    DistanceField playerDistance;
+    // Breaks ties between equally close steps the way the A* search did before the field
+    Pathfinder pathfinder;
+    // Record actions by player, taken from the front and undone from the back
+    std::deque<Action> actions;
+
+    void handleObjectAction();
+    void updateArrows();
+    void updateActors();
+    void handlePlayerAction(Action action);
+    bool playerIsDead();
+    bool playerReachedGoal();
+
+    // Snapshot of the stage as loaded, restored by reset()
+    WorldState initialState;
+
+    // Zobrist hash of the current state, updated as objects and the player move
+    std::uint64_t hash = 0;
+
+    // Grid cell index, also used as the tile number in hashes
+    int tileIndex(const sf::Vector2i& pos) const;
+    // Hash contribution of a monster or dispenser and of an arrow
+    std::uint64_t actorKey(int actor) const;
+    std::uint64_t arrowKey(int arrow) const;
+    std::uint64_t computeHash() const;
+    // Fill the bookkeeping above once the stage is loaded
+    void indexInitialState();
+
+public:
+    // Build the entities of a parsed stage
+    explicit Simulation(const StageDefinition& definition);
+    // Every member is a value (patterns are shared read-only), so a copy can be advanced independently
+    Simulation(const Simulation&) = default;
+    Simulation& operator=(const Simulation&) = default;
+    Simulation(Simulation&&) = default;
+    Simulation& operator=(Simulation&&) = default;
+
+    // Parse every stage of a stage file and build all of them
+    static void loadFromFile(const std::string& filename, std::vector<Simulation>& simulations);
+    // Parse a stage file only, reporting problems to the log and stderr
+    // Returns false if the file could not be read or a stage was skipped because of errors
+    static bool loadDefinitions(const std::string& filename, std::vector<StageDefinition>& definitions);
+
+    int getStageId() const;
+    int getRow() const;
+    int getColumn() const;
+    int getActionPerTurn() const;
+    const TileGrid& getTileMap() const;
+    // Tile as loaded, without monsters, arrows or the player (walls, goals, dispensers and open space)
+    char getStaticTile(int x, int y) const;
+    // Symbol to show for a tile: an arrow, else a monster, else the stage tile (for display and debug output)
+    char getTileSymbol(int x, int y) const;
+    const EntityStore& getEntities() const;
+    const WallRays& getWallRays() const;
+
+    // Tile of arrow i after `turns` more arrow passes (one per action), in O(1)
+    // Returns false if the arrow has been removed by then
+    bool predictArrow(int arrow, int turns, sf::Vector2i& position) const;
+    // Whether an arrow that is already flying will be on pos after `turns` arrow passes
+    // Arrows dispensed in the meantime are not included
+    bool arrowWillReach(const sf::Vector2i& pos, int turns) const;
+    // Tile of guard monster i after `turns` more actor passes, looked up in the stage's trajectory table
+    sf::Vector2i predictGuardMonster(int guard, int turns) const;
+    // Direction dispenser i tries to fire in `turns` more actor passes (0 is the next one), 0 if none
+    // The shot still fails if a monster or arrow stands on the spawn tile at that time
+    char predictDispenserShot(int dispenser, int turns) const;
+    const Player& getPlayer() const;
+
+    void addAction(const Action action);
+    bool reachMaxActions() const;
+    void undoLastAction();
+
+    // Advance by actionPerTurn actions (resets itself when the player dies)
+    TurnResult advance();
+    // Apply a single action immediately, ignoring the action queue
+    // Unlike advance(), a death is only reported and the state is left as is
+    TurnResult step(Action action);
+
+    // Zobrist hash of everything that can change during play
+    std::uint64_t getHash() const;
+    // Compact snapshot of the dynamic state and its inverse
+    WorldState saveState() const;
+    // Same snapshot written into state, reusing its entity storage
+    void saveState(WorldState& state) const;
+    void restoreState(const WorldState& state);
+
+    void print() const;
+    void reset();
+};
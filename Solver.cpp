@@ -0,0 +1,438 @@
+// Breadth-first level solver.
+// Loads stages with the same parser as the game and finds the shortest action sequence
+// that reaches a goal, or proves that no such sequence exists.
+// Each depth is expanded by all threads at once, and the result is the same on any thread count.
+//
+// Usage: solver [stage file] [--stage ID] [--max-states N] [--threads N] [--max-memory MB]
+#include "Types.hpp"
+#include "Simulation.hpp"
+#include "WorldState.hpp"
+#include "StateSet.hpp"
+#include "FrontierStore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Attack does nothing yet, so it is the same move as None and is not searched
+const Action SEARCH_ACTIONS[] = {
+    Action::MoveUp,
+    Action::MoveDown,
+    Action::MoveLeft,
+    Action::MoveRight,
+    Action::None,
+};
+constexpr int ACTION_COUNT = sizeof(SEARCH_ACTIONS) / sizeof(SEARCH_ACTIONS[0]);
+
+enum class SolveStatus {
+    Solved,
+    Unsolvable,
+    LimitReached,
+    MemoryLimitReached,
+    SpillFailed,
+};
+
+struct SolveResult {
+    SolveStatus status = SolveStatus::Unsolvable;
+    std::vector<Action> actions;
+    size_t statesExplored = 0;
+    size_t spilledBytes = 0;
+};
+
+struct SolveOptions {
+    size_t maxStates = 5000000;
+    // Visited set, parent links and frontier together; frontier blocks past it are spilled to disk
+    size_t maxMemory = size_t{4096} << 20;
+    int threads = 1;
+};
+
+char actionToChar(Action action) {
+    switch(action) {
+        case Action::MoveUp: return SYMBOL_UP;
+        case Action::MoveDown: return SYMBOL_DOWN;
+        case Action::MoveLeft: return SYMBOL_LEFT;
+        case Action::MoveRight: return SYMBOL_RIGHT;
+        default: return 'X'; // Same key as waiting in game
+    }
+}
+
+// Frontier blocks of one depth, dealt out to the threads in even runs.
+// Each thread works through its own run from the front and, once it is done, steals from the
+// back of the others, so a thread that drew slow blocks is helped instead of waited for.
+class BlockQueues {
+public:
+    explicit BlockQueues(int workerCount) : queues(workerCount) {}
+
+    void deal(size_t blockCount) {
+        size_t workerCount = queues.size();
+        for(size_t worker = 0; worker < workerCount; worker++) {
+            std::deque<size_t>& blocks = queues[worker].blocks;
+            blocks.clear();
+            for(size_t block = blockCount * worker / workerCount; block < blockCount * (worker + 1) / workerCount; block++) {
+                blocks.push_back(block);
+            }
+        }
+    }
+
+    bool take(int worker, size_t& block) {
+        if(popFront(queues[worker], block)) return true;
+        int workerCount = static_cast<int>(queues.size());
+        for(int i = 1; i < workerCount; i++) {
+            if(popBack(queues[(worker + i) % workerCount], block)) return true;
+        }
+        return false;
+    }
+
+private:
+    // Own cache line each, a thread mostly touches its own queue
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<size_t> blocks;
+    };
+    std::vector<Queue> queues;
+
+    static bool popFront(Queue& queue, size_t& block) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.blocks.empty()) return false;
+        block = queue.blocks.front();
+        queue.blocks.pop_front();
+        return true;
+    }
+
+    static bool popBack(Queue& queue, size_t& block) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.blocks.empty()) return false;
+        block = queue.blocks.back();
+        queue.blocks.pop_back();
+        return true;
+    }
+};
+
+// Meeting point of a fixed number of threads that can be passed again and again
+// (std::barrier only arrives with C++20)
+class Barrier {
+public:
+    explicit Barrier(int count) : count(count) {}
+
+    // Returns once all count threads have called it
+    void arriveAndWait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t arrivedIn = generation;
+        if(++arrived == count) {
+            arrived = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [this, arrivedIn] { return generation != arrivedIn; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    const int count;
+    int arrived = 0;
+    size_t generation = 0;
+};
+
+// Actions are applied one at a time inside a turn and the goal/death checks run after each
+// of them, so searching single actions gives the same reachable states as searching
+// actionPerTurn batches while branching far less. The shallowest goal is the par.
+//
+// The states of one depth are numbered by rank, and the move that applies action a to the
+// state of rank r has order r * ACTION_COUNT + a, the position a one-thread search would try
+// it at. A state reached at several places of a depth keeps its smallest order, and the
+// next depth is ranked by those orders. So ranks, parent links and the chosen goal are
+// exactly what a one-thread search in rank order gives, whichever thread got where first.
+class ParallelSearch {
+public:
+    ParallelSearch(const Simulation& start, const SolveOptions& options) :
+        start(start), options(options), queues(std::max(options.threads, 1)),
+        levelStart(std::max(options.threads, 1)), levelEnd(std::max(options.threads, 1)) {
+        for(int i = 0; i < std::max(options.threads, 1); i++) workers.emplace_back(start);
+    }
+
+    SolveResult run() {
+        // The helper threads live for the whole search and meet the calling thread around every depth
+        std::vector<std::thread> helpers;
+        for(int i = 1; i < static_cast<int>(workers.size()); i++) {
+            helpers.emplace_back([this, i] { helperLoop(i); });
+        }
+        SolveResult result = search();
+        stopping = true;
+        levelStart.arriveAndWait();
+        for(std::thread& helper : helpers) helper.join();
+        return result;
+    }
+
+private:
+    SolveResult search() {
+        SolveResult result;
+        visited.offer(start.getHash(), 0, 0);
+        levelOrders = {{0}};
+        size_t ordersBytes = sizeof(std::uint64_t);
+
+        auto current = std::make_unique<FrontierStore>();
+        std::vector<std::uint8_t> bytes;
+        FrontierStore::append(bytes, start.saveState());
+        current->addBlock(bytes, 1);
+
+        for(std::uint32_t level = 0; current->stateCount() > 0; level++) {
+            // The visited set and parent links have to stay in memory, only the frontier can move out
+            size_t fixedBytes = visited.memoryUsage() + ordersBytes;
+            if(fixedBytes >= options.maxMemory) {
+                result.status = SolveStatus::MemoryLimitReached;
+                return result;
+            }
+            auto next = std::make_unique<FrontierStore>();
+            size_t held = current->memoryBytes();
+            next->setMemoryBudget(options.maxMemory - fixedBytes > held ? options.maxMemory - fixedBytes - held : 0);
+
+            expandLevel(*current, *next, level);
+            result.spilledBytes += next->spilledBytes();
+            if(readFailed) {
+                result.status = SolveStatus::SpillFailed;
+                return result;
+            }
+
+            std::uint64_t goal = bestGoal;
+            if(goal != NO_GOAL) {
+                result.statesExplored += static_cast<size_t>(goal) + 1;
+                result.status = SolveStatus::Solved;
+                result.actions = rebuildActions(level, goal);
+                return result;
+            }
+            result.statesExplored += current->stateCount() * ACTION_COUNT;
+
+            rankNextLevel();
+            ordersBytes += levelOrders.back().size() * sizeof(std::uint64_t);
+            // Checked per depth, so the limit does not depend on thread timing
+            if(visited.size() >= options.maxStates) {
+                result.status = SolveStatus::LimitReached;
+                return result;
+            }
+            current = std::move(next);
+        }
+
+        // Every reachable state was visited without reaching a goal
+        result.status = SolveStatus::Unsolvable;
+        return result;
+    }
+
+    static constexpr std::uint64_t NO_GOAL = ~std::uint64_t{0};
+
+    // Everything a thread touches on its own while expanding
+    struct Worker {
+        explicit Worker(const Simulation& start) : scratch(start) {}
+        Simulation scratch;
+        // State being expanded and the state one of its moves led to
+        WorldState state;
+        WorldState child;
+        std::vector<std::uint8_t> input;
+        std::vector<std::uint8_t> output;
+        size_t outputStates = 0;
+        // Hashes this thread added to the visited set during the current depth
+        std::vector<std::uint64_t> reached;
+    };
+
+    const Simulation& start;
+    const SolveOptions& options;
+    StateSet visited;
+    // Sorted orders of the states of every depth; the state of rank r at depth d was reached
+    // from rank levelOrders[d][r] / ACTION_COUNT of depth d - 1
+    std::vector<std::vector<std::uint64_t>> levelOrders;
+    std::vector<Worker> workers;
+    BlockQueues queues;
+    std::atomic<std::uint64_t> bestGoal{NO_GOAL};
+    std::atomic<bool> readFailed{false};
+
+    // Depth being expanded, set by the calling thread before levelStart and read after it
+    Barrier levelStart;
+    Barrier levelEnd;
+    FrontierStore* levelCurrent = nullptr;
+    FrontierStore* levelNext = nullptr;
+    std::uint32_t levelDepth = 0;
+    bool stopping = false;
+
+    void helperLoop(int index) {
+        while(true) {
+            levelStart.arriveAndWait();
+            if(stopping) return;
+            work(index, *levelCurrent, *levelNext, levelDepth);
+            levelEnd.arriveAndWait();
+        }
+    }
+
+    void expandLevel(FrontierStore& current, FrontierStore& next, std::uint32_t level) {
+        queues.deal(current.blockCount());
+        for(Worker& worker : workers) worker.reached.clear();
+        levelCurrent = &current;
+        levelNext = &next;
+        levelDepth = level;
+
+        // The calling thread expands too; helpers that find no block left just wait at levelEnd
+        levelStart.arriveAndWait();
+        work(0, current, next, level);
+        levelEnd.arriveAndWait();
+    }
+
+    void work(int index, FrontierStore& current, FrontierStore& next, std::uint32_t level) {
+        Worker& worker = workers[index];
+        const std::vector<std::uint64_t>& orders = levelOrders[level];
+        size_t block;
+        while(queues.take(index, block)) {
+            if(!current.takeBlock(block, worker.input)) {
+                readFailed = true;
+                continue;
+            }
+            for(size_t offset = 0; offset < worker.input.size();) {
+                offset = FrontierStore::read(worker.input, offset, worker.state);
+
+                std::uint32_t reachedLevel = 0;
+                std::uint64_t order = 0;
+                visited.find(worker.state.hash, reachedLevel, order);
+                std::uint64_t rank = std::lower_bound(orders.begin(), orders.end(), order) - orders.begin();
+                // Every move from here comes after a goal that is already known
+                if(rank * ACTION_COUNT > bestGoal.load(std::memory_order_relaxed)) continue;
+
+                for(int a = 0; a < ACTION_COUNT; a++) {
+                    worker.scratch.restoreState(worker.state);
+                    TurnResult turnResult = worker.scratch.step(SEARCH_ACTIONS[a]);
+                    std::uint64_t move = rank * ACTION_COUNT + a;
+
+                    // Dying resets the stage, which never gets closer to a solution
+                    if(turnResult == TurnResult::PlayerDied) continue;
+
+                    if(turnResult == TurnResult::StageCleared) {
+                        std::uint64_t best = bestGoal.load();
+                        while(move < best && !bestGoal.compare_exchange_weak(best, move)) {}
+                        continue;
+                    }
+
+                    // Prune states already reached with fewer actions
+                    if(!visited.offer(worker.scratch.getHash(), level + 1, move)) continue;
+
+                    worker.reached.push_back(worker.scratch.getHash());
+                    worker.scratch.saveState(worker.child);
+                    FrontierStore::append(worker.output, worker.child);
+                    worker.outputStates++;
+                    if(worker.output.size() >= FrontierStore::BLOCK_BYTES) flushOutput(worker, next);
+                }
+            }
+        }
+        flushOutput(worker, next);
+    }
+
+    static void flushOutput(Worker& worker, FrontierStore& next) {
+        if(worker.outputStates == 0) return;
+        next.addBlock(worker.output, worker.outputStates);
+        worker.outputStates = 0;
+    }
+
+    // Rank the states first reached during the last depth by the smallest order each got
+    void rankNextLevel() {
+        std::vector<std::uint64_t> orders;
+        for(const Worker& worker : workers) {
+            for(std::uint64_t hash : worker.reached) {
+                std::uint32_t reachedLevel = 0;
+                std::uint64_t order = 0;
+                visited.find(hash, reachedLevel, order);
+                orders.push_back(order);
+            }
+        }
+        std::sort(orders.begin(), orders.end());
+        levelOrders.push_back(std::move(orders));
+    }
+
+    // Follow the parent links back from the goal reached by move `goal` while expanding `level`
+    std::vector<Action> rebuildActions(std::uint32_t level, std::uint64_t goal) const {
+        std::vector<Action> actions = {SEARCH_ACTIONS[goal % ACTION_COUNT]};
+        std::uint64_t rank = goal / ACTION_COUNT;
+        for(std::uint32_t depth = level; depth > 0; depth--) {
+            std::uint64_t order = levelOrders[depth][rank];
+            actions.push_back(SEARCH_ACTIONS[order % ACTION_COUNT]);
+            rank = order / ACTION_COUNT;
+        }
+        return std::vector<Action>(actions.rbegin(), actions.rend());
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string stageFile = "stages.txt";
+    int onlyStage = 0;
+    SolveOptions options;
+    options.threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--stage" && i + 1 < argc) {
+            onlyStage = std::atoi(argv[++i]);
+        } else if(arg == "--max-states" && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], nullptr, 10);
+        } else if(arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--max-memory" && i + 1 < argc) {
+            options.maxMemory = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) << 20;
+        } else if(arg == "--help" || arg == "-h") {
+            std::printf("Usage: %s [stage file] [--stage ID] [--max-states N] [--threads N] [--max-memory MB]\n", argv[0]);
+            return 0;
+        } else {
+            stageFile = arg;
+        }
+    }
+
+    std::vector<Simulation> simulations;
+    Simulation::loadFromFile(stageFile, simulations);
+    if(simulations.empty()) {
+        std::fprintf(stderr, "No stages loaded from %s\n", stageFile.c_str());
+        return 2;
+    }
+
+    bool allSolved = true;
+    for(const Simulation& simulation : simulations) {
+        if(onlyStage > 0 && simulation.getStageId() != onlyStage) continue;
+
+        auto begin = std::chrono::steady_clock::now();
+        SolveResult result = ParallelSearch(simulation, options).run();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        std::printf("Stage %d: ", simulation.getStageId());
+        if(result.status == SolveStatus::Solved) {
+            int moves = static_cast<int>(result.actions.size());
+            int turns = (moves + simulation.getActionPerTurn() - 1) / simulation.getActionPerTurn();
+            std::string sequence;
+            for(Action action : result.actions) sequence += actionToChar(action);
+            std::printf("par %d moves (%d turns) %s", moves, turns, sequence.c_str());
+        } else if(result.status == SolveStatus::Unsolvable) {
+            std::printf("UNSOLVABLE");
+            allSolved = false;
+        } else if(result.status == SolveStatus::LimitReached) {
+            std::printf("SEARCH LIMIT REACHED");
+            allSolved = false;
+        } else if(result.status == SolveStatus::MemoryLimitReached) {
+            std::printf("MEMORY LIMIT REACHED");
+            allSolved = false;
+        } else {
+            std::printf("SPILL FILE UNREADABLE");
+            allSolved = false;
+        }
+        std::printf(" [%zu states, %.1f ms", result.statesExplored, ms);
+        if(result.spilledBytes > 0) std::printf(", %.1f MB spilled", result.spilledBytes / 1048576.0);
+        std::printf("]\n");
+    }
+
+    return allSolved ? 0 : 1;
+}
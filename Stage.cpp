@@ -3,6 +3,7 @@
 #include "Logger.hpp"
 #include "Stage.hpp"
 #include "Object.hpp"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -12,240 +13,79 @@ RoundedRectangle Stage::buttonSelect(0, 0, 0, 0, 0, 0, "", 0, Resource::getButto
 RoundedRectangle Stage::buttonRetry(0, 0, 0, 0, 0, 0, "", 0, Resource::getButtonFont());
 RoundedRectangle Stage::buttonNext(0, 0, 0, 0, 0, 0, "", 0, Resource::getButtonFont());
 
-Stage::Stage(int stageId, int column, int row, int actionPerTurn) : stageId(stageId), row(row), column(column), actionPerTurn(actionPerTurn), 
-    openSpace(Resource::getOpenSpaceTexture()), backgroundSprite(Resource::getBackgroundStageTexture()),
-    stageClearSprite(Resource::getStageClearTexture()) {
-    // Initialize tile size based on window size and number of tiles
-    this->tileSize = std::min(WORLD_WIDTH / (column + 1), WORLD_HEIGHT / (row + 1));
-
-    // Initialize start positions for the tile map in window coordinates
-    this->start_x = (WORLD_WIDTH - (column * tileSize)) / 2.f;
-    this->start_y = (WORLD_HEIGHT - (row * tileSize)) / 2.f;
-    
-    // Initialize tile map with open space '-'
-    tileMap.resize(row, std::vector<char>(column, '-'));
-
-    resizeTileTexture(openSpace, tileSize);
-    openSpace.setPosition({start_x, start_y});
-
-    resizeTileTexture(stageClearSprite, std::min(WORLD_WIDTH, WORLD_HEIGHT) * 0.8f);
-    stageClearSprite.setPosition({(WORLD_WIDTH - stageClearSprite.getGlobalBounds().size.x) / 2.f, 
-        (WORLD_HEIGHT - stageClearSprite.getGlobalBounds().size.y) / 2.f});
-    stageClearShape.setSize({WORLD_WIDTH, WORLD_HEIGHT});
-    stageClearShape.setFillColor(STAGE_CLEAR_TRANSLUCENT);
-
-    setBackground(backgroundSprite, Resource::getBackgroundStageTexture(), BACKGROUND_TRANSLUCENT_STRONGER);
-    
-    // Create visual tiles for the stage (will be called after loading map from file)
-    // createTiles(100) should be called after map is loaded
-    
-    Logger::log("Stage " + std::to_string(stageId) + " created with size (" 
-        + std::to_string(column) + ", " + std::to_string(row) + ").");
+// Smallest rectangle holding both a and b
+static sf::FloatRect unite(const sf::FloatRect& a, const sf::FloatRect& b) {
+    sf::Vector2f topLeft{std::min(a.position.x, b.position.x), std::min(a.position.y, b.position.y)};
+    sf::Vector2f bottomRight{std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+        std::max(a.position.y + a.size.y, b.position.y + b.size.y)};
+    return {topLeft, bottomRight - topLeft};
 }
 
-void Stage::createFromFile(std::vector<Stage>& stages) {
-    std::ifstream file(STAGE_FILE);
-    if(!file.is_open()) {
-        Logger::log("Failed to open " + STAGE_FILE + " for stages creation.");
-        return;
-    }
+Stage::Stage(Simulation&& simulation) : simulation(std::move(simulation)),
+    backgroundSprite(Resource::getBackgroundStageTexture()),
+    tileColorLayer(sf::PrimitiveType::Triangles), floorLayer(sf::PrimitiveType::Triangles),
+    staticObjectLayer(sf::PrimitiveType::Triangles), dynamicObjectLayer(sf::PrimitiveType::Triangles),
+    stageClearSprite(Resource::getStageClearTexture()) {
+    int row = this->simulation.getRow();
+    int column = this->simulation.getColumn();
 
-    std::string line;
-    while(std::getline(file, line)) {
-        if(line != "STAGE_START") continue; // Find next stage block
-
-        int stageId = 0;
-        int column = 0;
-        int row = 0;
-        int actionPerTurn = 1;
-
-        // Parse header lines: STAGE_ID, COLUMN, ROW
-        while(std::getline(file, line)) {
-            if(line.rfind("STAGE_ID:", 0) == 0) {
-                stageId = std::stoi(line.substr(std::string("STAGE_ID:").size()));
-                Logger::log("Loading Stage: " + std::to_string(stageId));
-            } else if(line.rfind("COLUMN:", 0) == 0) {
-                column = std::stoi(line.substr(std::string("COLUMN:").size()));
-            } else if(line.rfind("ROW:", 0) == 0) {
-                row = std::stoi(line.substr(std::string("ROW:").size()));
-            } else if(line.rfind("ACTION_PER_TURN:", 0) == 0) {
-                actionPerTurn = std::stoi(line.substr(std::string("ACTION_PER_TURN:").size()));
-            } else if(line == "PATTERN_START") {
-                break; // Proceed to pattern parsing
-            }
-        }
+    // Initialize tile size based on window size and number of tiles
+    this->tileSize = std::min(Config::WORLD_WIDTH / (column + 1), Config::WORLD_HEIGHT / (row + 1));
 
-        if(stageId <= 0 || column <= 0 || row <= 0) {
-            Logger::log("Invalid stage header encountered. Skipping.");
-            // Skip to next STAGE_END
-            while(std::getline(file, line) && line != "STAGE_END");
-            continue;
+    // Initialize start positions for the tile map in window coordinates
+    this->start_x = (Config::WORLD_WIDTH - (column * tileSize)) / 2.f;
+    this->start_y = (Config::WORLD_HEIGHT - (row * tileSize)) / 2.f;
+
+    // Floor texture for every tile
+    for(int r = 0; r < row; r++) {
+        for(int c = 0; c < column; c++) {
+            AtlasTile floorTile = Resource::getOpenSpaceTile(getVariantNumber());
+            appendTileQuad(floorLayer, tileToWindow({c, r}), tileSize, Resource::getAtlasRect(floorTile));
         }
+    }
 
-        Stage stage(stageId, column, row, actionPerTurn);
-
-        // Parse pattern section
-        std::string guardMonsterPattern;
-        std::string dispenserPattern;
-        std::string slicedPattern;
-
-        if(line == "PATTERN_START") {
-            Logger::log_debug("Parsing patterns for stage " + std::to_string(stageId));
-            // Read until PATTERN_END
-            while(std::getline(file, line) && line != "PATTERN_END") {
-                line = trim(line);
-                if(line.rfind("DISPENSER:", 0) == 0) {
-                    dispenserPattern = line.substr(std::string("DISPENSER:").size());
-                    // Remove leading/trailing whitespace
-                    dispenserPattern = trim(dispenserPattern);
-                } else if(line.rfind("GUARD_MONSTER:", 0) == 0) {
-                    guardMonsterPattern = line.substr(std::string("GUARD_MONSTER:").size());
-                    // e.g. U2D2L4 -> UUDDLLLL
-                    guardMonsterPattern = processPattern(guardMonsterPattern);
-                    // Remove leading/trailing whitespace
-                    guardMonsterPattern = trim(guardMonsterPattern);
-                }
-            }
-        }
-        // Store patterns into stage
-        stage.setPatternGuardMonster(guardMonsterPattern);
-        stage.setPatternDispenser(dispenserPattern);
-
-        // Find MAP_START
-        while(std::getline(file, line) && line != "MAP_START") {
-            if(line == "STAGE_END") {
-                Logger::log_debug("Warning: MAP_START not found for stage " + std::to_string(stageId));
-                break;
+    // Walls, goals and dispensers never move, they are read straight from the stage tiles
+    for(int r = 0; r < row; r++) {
+        for(int c = 0; c < column; c++) {
+            switch(this->simulation.getStaticTile(c, r)) {
+                case SYMBOL_WALL: appendEntity(staticObjectLayer, AtlasTile::Wall, {c, r}); break;
+                case SYMBOL_GOAL: appendEntity(staticObjectLayer, AtlasTile::Goal, {c, r}); break;
+                case SYMBOL_DISPENSER: appendEntity(staticObjectLayer, AtlasTile::Dispenser, {c, r}); break;
+                default: break;
             }
         }
+    }
 
-        // Parse map lines until MAP_END
-        int r = 0;
-        while(std::getline(file, line)) {
-            if(line == "MAP_END") break;
-            if(line.size() >= 2 && line[0] == '#' && line[1] == '#') continue; // skip comment lines starting with '##'
-            if(line.empty()) continue;
-            // Ensure the line length matches column (allow shorter lines, fill with '-')
-            for(int c = 0; c < column && c < static_cast<int>(line.size()); c++) {
-                char ch = line[c];
-                stage.tileMap[r][c] = ch;
-                // Initial position in window coordinates (middle)
-                sf::Vector2f posWindow = {stage.start_x + c * stage.tileSize, stage.start_y + r * stage.tileSize};
-
-                // Tile sprite creation
-                int variant = getVariantNumber();
-                sf::Sprite tileSprite(Resource::getOpenSpaceTexture(variant));
-                tileSprite.setPosition(posWindow);
-                resizeTileTexture(tileSprite, stage.tileSize);
-                stage.tileSprites.emplace_back(tileSprite);
-
-                // Object creation based on symbol
-                // Player
-                if(ch == SYMBOL_PLAYER) {
-                    // posWindow will be adjusted to the middle of the tile in Object constructor
-                    stage.player = std::make_unique<Player>(sf::Vector2i{c, r}, posWindow, stage.tileSize);
-                    stage.initialPlayer = std::make_unique<Player>(sf::Vector2i{c, r}, posWindow, stage.tileSize);
-                    // Leave open space for player start
-                    stage.tileMap[r][c] = SYMBOL_OPEN_SPACE;
-                }
-
-                // Walls
-                else if(ch == SYMBOL_WALL) {
-                    stage.objects.emplace_back(std::make_unique<Wall>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                    stage.initialObjects.emplace_back(std::make_unique<Wall>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                }
-
-                // Goals
-                else if(ch == SYMBOL_GOAL) {
-                    stage.objects.emplace_back(std::make_unique<Goal>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                    stage.initialObjects.emplace_back(std::make_unique<Goal>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                }
-
-                // Trace monsters 
-                else if(ch == SYMBOL_TRACE_MONSTER) {
-                    stage.objects.emplace_back(std::make_unique<TraceMonster>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                    stage.initialObjects.emplace_back(std::make_unique<TraceMonster>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize));
-                }
-
-                // Guard monsters 
-                else if(ch == SYMBOL_GUARD_MONSTER) {
-                    // Extract the first pattern segment (from start to first semicolon)
-                    int semicolonPos = guardMonsterPattern.find(';');
-                    if(semicolonPos != std::string::npos) {
-                        slicedPattern = guardMonsterPattern.substr(0, semicolonPos);
-                        guardMonsterPattern = guardMonsterPattern.substr(semicolonPos + 1);
-                    } else {
-                        slicedPattern = guardMonsterPattern;
-                    }
-                    stage.objects.emplace_back(std::make_unique<GuardMonster>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize, slicedPattern));
-                    stage.initialObjects.emplace_back(std::make_unique<GuardMonster>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize, slicedPattern));
-                }
-
-                // Dispensers
-                else if(ch == SYMBOL_DISPENSER) {
-                    // Extract the first pattern segment (from start to first semicolon)
-                    int semicolonPos = dispenserPattern.find(';');
-                    if(semicolonPos != std::string::npos) {
-                        slicedPattern = dispenserPattern.substr(0, semicolonPos);
-                        dispenserPattern = dispenserPattern.substr(semicolonPos + 1);
-                    } else {
-                        slicedPattern = dispenserPattern;
-                    }
-                    stage.objects.emplace_back(std::make_unique<Dispenser>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize, slicedPattern));
-                    stage.initialObjects.emplace_back(std::make_unique<Dispenser>(
-                        sf::Vector2i{c, r}, posWindow, stage.tileSize, slicedPattern));
-                }
-            }
+    resizeTileTexture(stageClearSprite, std::min(Config::WORLD_WIDTH, Config::WORLD_HEIGHT) * 0.8f);
+    stageClearSprite.setPosition({(Config::WORLD_WIDTH - stageClearSprite.getGlobalBounds().size.x) / 2.f,
+        (Config::WORLD_HEIGHT - stageClearSprite.getGlobalBounds().size.y) / 2.f});
+    stageClearShape.setSize({static_cast<float>(Config::WORLD_WIDTH), static_cast<float>(Config::WORLD_HEIGHT)});
+    stageClearShape.setFillColor(STAGE_CLEAR_TRANSLUCENT);
 
-            // Fill remaining columns with open space if line shorter
-            for(int c = static_cast<int>(line.size()); c < column; ++c) {
-                stage.tileMap[r][c] = '-';
-            }
-            r++;
-            if(r >= row) {
-                // consume remaining lines up to MAP_END
-                while(std::getline(file, line) && line != "MAP_END");
-                break;
-            }
-        }
+    setBackground(backgroundSprite, Resource::getBackgroundStageTexture(), BACKGROUND_TRANSLUCENT_STRONGER);
 
-        // Save initial state for reset
-        stage.initialTileMap = stage.tileMap;
+    createTiles();
 
-        // Handle if symbol of player not found
-        if(!stage.player) {
-            Logger::log("Warning: Player symbol not found in stage " + std::to_string(stageId) + ". Creating default player at (0,0).");
-            stage.player = std::make_unique<Player>(sf::Vector2i{0, 0}, 
-                sf::Vector2f{stage.start_x, stage.start_y}, stage.tileSize);
-            stage.initialPlayer = std::make_unique<Player>(sf::Vector2i{0, 0}, 
-                sf::Vector2f{stage.start_x, stage.start_y}, stage.tileSize);
-        }
+    // Everything the player does from here on can be replayed and rewound
+    recorder.begin(this->simulation, history.getCapacity());
+    history.reset(this->simulation.saveState());
 
-        // Advance to STAGE_END
-        while(line != "STAGE_END" && std::getline(file, line)) {}
+    // Only the area the static layers cover is cached, sized once the window's view is known
+    staticBounds = backgroundSprite.getGlobalBounds();
+    for(const sf::VertexArray* layer : {&tileColorLayer, &floorLayer, &staticObjectLayer}) {
+        if(layer->getVertexCount() > 0) staticBounds = unite(staticBounds, layer->getBounds());
+    }
+    invalidateStaticLayer();
+}
 
-        stage.createTiles();
-        Logger::log("Total objects in stage " + std::to_string(stageId) + ": " + std::to_string(stage.objects.size()));
-        Logger::log("Stage " + std::to_string(stageId) + " loaded from file.");
-        stage.print();
+void Stage::createFromFile(StageLibrary& stages) {
+    // Stages are only parsed here, each one is built when it is first played
+    stages.load(STAGE_FILE);
 
-        // Add stage to stages vector
-        stages.emplace_back(std::move(stage));
-    }
-        
     // Setup stage clear overlay
-    Stage::stageClearShape.setSize({WORLD_WIDTH, WORLD_HEIGHT});
+    Stage::stageClearShape.setSize({static_cast<float>(Config::WORLD_WIDTH), static_cast<float>(Config::WORLD_HEIGHT)});
     Stage::stageClearShape.setFillColor(STAGE_CLEAR_TRANSLUCENT);
-        
+
     Stage::buttonSelect = RoundedRectangle(
         BUTTON_CENTER_X - 250, BUTTON_CENTER_Y + 50,
         BUTTON_RECTANGLE_WIDTH - 40, BUTTON_RECTANGLE_HEIGHT,
@@ -264,251 +104,156 @@ void Stage::createFromFile(std::vector<Stage>& stages) {
         BUTTON_CIRCLE_RADIUS, BUTTON_SHADOW_OFFSET,
         "NEXT", 30, Resource::getButtonFont()
     );
-
-    file.close();
 }
 
 void Stage::createTiles() {
-    for(int i = 0; i < row; i++) {
-        for(int j = 0; j < column; j++) {
-            // Use new to allocate on heap to prevent going out of scope
-            sf::RectangleShape* tile = new sf::RectangleShape(sf::Vector2f(tileSize, tileSize));
-            
-            // Set position
-            float x = start_x + j * tileSize;
-            float y = start_y + i * tileSize;
-            tile->setPosition({x, y});
-            
+    tileColorLayer.clear();
+    for(int i = 0; i < simulation.getRow(); i++) {
+        for(int j = 0; j < simulation.getColumn(); j++) {
             // Checkerboard colors
-            char tileType = tileMap[i][j];
+            sf::Color color;
+            char tileType = simulation.getTileSymbol(j, i);
             switch(tileType) {
                 case SYMBOL_PLAYER:
-                    tile->setFillColor(TILE_COLOR_PLAYER);
+                    color = TILE_COLOR_PLAYER;
                     break;
                 case SYMBOL_GOAL:
-                    tile->setFillColor(TILE_COLOR_GOAL);
+                    color = TILE_COLOR_GOAL;
                     break;
                 case SYMBOL_WALL:
-                    tile->setFillColor(TILE_COLOR_WALL);
+                    color = TILE_COLOR_WALL;
                     break;
                 case SYMBOL_DISPENSER:
-                    tile->setFillColor(TILE_COLOR_DISPENSER);
+                    color = TILE_COLOR_DISPENSER;
                     break;
                 case SYMBOL_TRACE_MONSTER:
-                    tile->setFillColor(TILE_COLOR_TRACE_MONSTER);
+                    color = TILE_COLOR_TRACE_MONSTER;
                     break;
                 case SYMBOL_GUARD_MONSTER:
-                    tile->setFillColor(TILE_COLOR_GUARD_MONSTER);
+                    color = TILE_COLOR_GUARD_MONSTER;
                     break;
                 case SYMBOL_OPEN_SPACE:
                 default:
-                    tile->setFillColor(TILE_COLOR_NORMAL);
+                    color = TILE_COLOR_NORMAL;
                     break;
             }
-            
-            shapes.emplace_back(std::unique_ptr<sf::Shape>(tile));
-            Logger::log_debug("Created tile at (" + std::to_string(j) + ", " + std::to_string(i) + ") of type '" 
-                + tileType + "' at position (" + std::to_string(x) + ", " + std::to_string(y) + ").");
+
+            // Untextured, so the texture rectangle is irrelevant
+            appendTileQuad(tileColorLayer, tileToWindow({j, i}), tileSize, sf::IntRect(), color);
         }
     }
 }
 
-int Stage::getRow() const { return row; }
-int Stage::getColumn() const { return column; }
-Player& Stage::getPlayer() { return *player; }
-
-void Stage::setPatternDispenser(const std::string& pattern) {
-    patternDispenser = pattern;
-}
-
-void Stage::setPatternGuardMonster(const std::string& pattern) {
-    patternGuardMonster = pattern;
-}
+int Stage::getRow() const { return simulation.getRow(); }
+int Stage::getColumn() const { return simulation.getColumn(); }
+const Player& Stage::getPlayer() const { return simulation.getPlayer(); }
+Simulation& Stage::getSimulation() { return simulation; }
 
 void Stage::addAction(const Action action) {
-    actions.push(action);
+    simulation.addAction(action);
+    recorder.recordAction(action);
 }
 
 bool Stage::reachMaxActions() const {
-    return actions.size() >= static_cast<size_t>(actionPerTurn);
+    return simulation.reachMaxActions();
 }
 
 void Stage::undoLastAction() {
-    if(actions.empty()) {
-        Logger::log_debug("No actions to undo.");
-        return;
-    }
-
-    // Remove the last action added
-    std::queue<Action> tempQueue;
-    int actionCount = actions.size();
-    for(int i = 0; i < actionCount - 1; i++) {
-        tempQueue.push(actions.front());
-        actions.pop();
-    }
-    actions.pop(); // Remove the last action
-
-    // Restore the remaining actions back to the original queue
-    actions = std::move(tempQueue);
-
-    Logger::log_debug("Last action undone. Remaining actions: " + std::to_string(actions.size()));
+    simulation.undoLastAction();
+    recorder.recordUndo();
 }
 
-void Stage::handleObjectAction() {
-    Logger::log("Handling object action.");
-    
-    // First handle projectiles
-    for(int i = 0; i < objects.size(); i++) {
-        std::unique_ptr<Object>& object = objects[i];
-
-        if(Arrow* arrow = dynamic_cast<Arrow*>(object.get())) {
-            // Store old position before update
-            sf::Vector2i oldPosTile = arrow->posTile;
-            
-            // Update arrow
-            arrow->update(tileMap, tileSize);
-            if(shouldRemoveProjectile(arrow, arrow->getOriginalPosTile(), i)) {
-                objectsToRemove.push_back(i);
-            }
-        }
-    }
-    // Then handle other objects
-    for(int i = 0; i < objects.size(); i++) {
-        std::unique_ptr<Object>& object = objects[i];
-        
-        // Use .get() to access the raw pointer from unique_ptr
-        if(TraceMonster* traceMonster = dynamic_cast<TraceMonster*>(object.get())) {
-            traceMonster->update(tileMap, tileSize, player->posTile);
-        } else if(GuardMonster* guardMonster = dynamic_cast<GuardMonster*>(object.get())) {
-            guardMonster->update(tileMap, tileSize);
-        } else if(Dispenser* dispenser = dynamic_cast<Dispenser*>(object.get())) {
-            dispenser->update(tileMap, tileSize, bufferObjects);
-        }
-    }
-
-    // Add buffered objects to main objects vector
-    for(auto& bufferedObject : bufferObjects) {
-        objects.emplace_back(std::move(bufferedObject));
-    }
-    bufferObjects.clear();
-    
-    // Remove projectiles in reverse order to avoid index shifting issues
-    for(int i = objectsToRemove.size() - 1; i >= 0; i--) {
-        int removeIndex = objectsToRemove[i];
-        objects.erase(objects.begin() + removeIndex);
-        Logger::log_debug("Removed arrow at index " + std::to_string(removeIndex));
-    }
-    objectsToRemove.clear();
-
-    Logger::log_debug("Remaining objects after handling actions: " + std::to_string(objects.size()));
-}
-
-void Stage::handlePlayerAction() {
-    Logger::log("Handling player action.");
-    Action action = actions.front();
-    actions.pop();
-
-    switch(action) {
-        case Action::MoveUp:
-        case Action::MoveDown:
-        case Action::MoveLeft:
-        case Action::MoveRight:
-            player->update(tileMap, tileSize, action);
-            break;
-        case Action::Attack:
-            // To be implemented
-            break;
-        case Action::None:
-            break;
+void Stage::advance(GameState& gameState) {
+    TurnResult result = simulation.advance();
+    recorder.recordAdvance(simulation);
+    simulation.saveState(scratchState);
+    history.push(scratchState);
+    if(result == TurnResult::StageCleared) {
+        gameState = GameState::StageClear;
     }
 }
 
-bool Stage::shouldRemoveProjectile(Projectile* projectile, sf::Vector2i oldPosTile, int i) {
-    // If projectile position didn't change, it hit a wall or obstacle
-    if(projectile->posTile == oldPosTile) {
-        tileMap[projectile->posTile.y][projectile->posTile.x] = '-';
-        Logger::log_debug("Arrow at (" + std::to_string(oldPosTile.x) + ", " + std::to_string(oldPosTile.y) + ") stopped and will be removed.");
-        return true;
-    } 
-
-    return false;
+sf::Vector2f Stage::tileToWindow(const sf::Vector2i& posTile) const {
+    return {start_x + posTile.x * tileSize, start_y + posTile.y * tileSize};
 }
 
-bool Stage::playerIsDead() {
-    // End position of player collides with any monster or projectile
-    char endTile = tileMap[player->posTile.y][player->posTile.x];
-    if(endTile == SYMBOL_TRACE_MONSTER || endTile == SYMBOL_GUARD_MONSTER || endTile == SYMBOL_ARROW) {
-        Logger::log("Player collided with a dangerous object at (" 
-            + std::to_string(player->posTile.x) + ", " + std::to_string(player->posTile.y) + ").");
-        return true;
-    }
-
-    // Player bumps into any monster or projectile
-    // Temporary no need to check
-
-    return false;
+void Stage::appendEntity(sf::VertexArray& layer, AtlasTile tile, const sf::Vector2i& posTile, int quarterTurns) {
+    appendTileQuad(layer, tileToWindow(posTile), tileSize, Resource::getAtlasRect(tile), sf::Color::White, quarterTurns);
 }
 
-bool Stage::playerReachedGoal() {
-    // End position of player is on goal tile
-    char endTile = tileMap[player->posTile.y][player->posTile.x];
-    if(endTile == SYMBOL_GOAL) {
-        Logger::log("Player reached the goal at (" 
-            + std::to_string(player->posTile.x) + ", " + std::to_string(player->posTile.y) + ").");
-        return true;
-    }
-
-    return false;
+void Stage::drawStaticLayers(sf::RenderTarget& target) {
+    sf::RenderStates atlasStates(&Resource::getAtlasTexture());
+    target.draw(backgroundSprite);
+    target.draw(tileColorLayer);
+    target.draw(floorLayer, atlasStates);
+    target.draw(staticObjectLayer, atlasStates);
 }
 
-void Stage::advance(GameState& gameState) {
-    Logger::log("Advancing stage by " + std::to_string(actionPerTurn) + " actions.");
-    for(int i = 0; i < actionPerTurn; i++) {
-        if(actions.empty()) {
-            Logger::log_debug("No more actions to handle.");
-            break;
-        }
-        handleObjectAction();
-        handlePlayerAction();
-        if(playerIsDead()) {
-            Logger::log("Player has died. Stopping stage advance. Starting reset.");
-            Logger::log_debug("Stage state before reset:");
-            print();
-            reset();
-            return;
-        }
-        if(playerReachedGoal()) {
-            Logger::log("Player has reached the goal! Stopping stage advance.");
-            gameState = GameState::StageClear;
+void Stage::bakeStaticLayer(const sf::RenderTarget& target) {
+    staticLayerDirty = false;
+
+    // One texture pixel per window pixel, so the cached layer is as sharp as drawing directly
+    sf::Vector2i topLeft = target.mapCoordsToPixel(staticBounds.position);
+    sf::Vector2i bottomRight = target.mapCoordsToPixel(staticBounds.position + staticBounds.size);
+    sf::Vector2u size{static_cast<unsigned>(std::max(1, bottomRight.x - topLeft.x)),
+        static_cast<unsigned>(std::max(1, bottomRight.y - topLeft.y))};
+    if(!staticLayerAvailable || staticLayer.getSize() != size) {
+        staticLayerAvailable = staticLayer.resize(size);
+        if(!staticLayerAvailable) {
+            LOG_INFO("Failed to create static layer texture. Drawing stage layers directly.");
             return;
         }
     }
-    Logger::log_debug("Stage advanced.");
-    Logger::log_debug("Stage state after advance:");
-    print();
+    staticLayer.setView(sf::View(staticBounds));
+
+    // The window is cleared to black before the stage is drawn, so the translucent
+    // background is composited over black here to give exactly the same pixels
+    staticLayer.clear(sf::Color::Black);
+    drawStaticLayers(staticLayer);
+    staticLayer.display();
+    staticLayerDirty = false;
+    LOG_DEBUG("Static layer baked for stage " + std::to_string(simulation.getStageId()) + ".");
 }
 
-void Stage::draw(sf::RenderWindow& window, const GameState& gameState) {
-    // Draw background
-    window.draw(backgroundSprite);
+void Stage::invalidateStaticLayer() {
+    staticLayerDirty = true;
+}
 
-    // Draw all shapes
-    for(const auto& shape : shapes) {
-        window.draw(*shape);
+void Stage::draw(sf::RenderWindow& window, const GameState& gameState) {
+    sf::RenderStates atlasStates(&Resource::getAtlasTexture());
+
+    // Background, tiles, walls, goals and dispensers
+    if(staticLayerDirty) bakeStaticLayer(window);
+    if(staticLayerAvailable) {
+        sf::Sprite cached(staticLayer.getTexture());
+        cached.setPosition(staticBounds.position);
+        cached.setScale({staticBounds.size.x / staticLayer.getSize().x, staticBounds.size.y / staticLayer.getSize().y});
+        window.draw(cached);
+    } else {
+        drawStaticLayers(window);
     }
 
-    // Draw open space tiles which are not objects
-    for(const auto& tileSprite : tileSprites) {
-        window.draw(tileSprite);
+    // Moving objects, then the player on top
+    // Each kind is read from its own array of the entity store
+    const EntityStore& entities = simulation.getEntities();
+    dynamicObjectLayer.clear();
+    for(const sf::Vector2i& position : entities.traceMonsters) {
+        appendEntity(dynamicObjectLayer, AtlasTile::TraceMonster, position);
     }
-
-    //Draw all objects
-    for(auto& object : objects) {
-        object->draw(window, tileSize);
+    for(const sf::Vector2i& position : entities.guardMonsters.positions) {
+        appendEntity(dynamicObjectLayer, AtlasTile::GuardMonster, position);
     }
-
-    // Draw player
-    player->draw(window, tileSize);
+    for(int i = 0; i < entities.arrowCount(); i++) {
+        // Arrows are rotated to their direction. Default texture faces LEFT.
+        char direction = entities.arrows.getDirection(i);
+        int quarterTurns = 0;
+        if(direction == SYMBOL_UP) quarterTurns = 1;
+        else if(direction == SYMBOL_RIGHT) quarterTurns = 2;
+        else if(direction == SYMBOL_DOWN) quarterTurns = 3;
+        appendEntity(dynamicObjectLayer, AtlasTile::Arrow, entities.arrows.getPosition(i), quarterTurns);
+    }
+    appendEntity(dynamicObjectLayer, AtlasTile::Player, simulation.getPlayer().posTile);
+    window.draw(dynamicObjectLayer, atlasStates);
 
     // If stage clear, draw stage clear sprite
     if(gameState == GameState::StageClear) {
@@ -521,74 +266,64 @@ void Stage::draw(sf::RenderWindow& window, const GameState& gameState) {
 }
 
 void Stage::print() const {
-    Logger::log_debug("=====================");
-    Logger::log_debug("Printing tile map for Stage " + std::to_string(stageId) + ":");
-    Logger::log_debug("Size (" + std::to_string(column) + ", " + std::to_string(row) + "):");
-    Logger::log_debug("Action Per Turn: " + std::to_string(actionPerTurn));
-    Logger::log_debug("=====================");
-    for(const auto& row : tileMap) {
-        std::string line;
-        for(const auto& tile : row) {
-            line += tile;
-        }
-        Logger::log_debug(line);
-    }
-    Logger::log_debug("=====================");
-    Logger::log_debug("Pattern Guard Monster: " + patternGuardMonster);
-    Logger::log_debug("Pattern Dispenser: " + patternDispenser);
-    Logger::log_debug("=====================");
+    simulation.print();
 }
 
 void Stage::reset() {
-    Logger::log("Resetting stage " + std::to_string(stageId) + " to initial state.");
-
-    // Clear any queued actions
-    while(!actions.empty()) actions.pop();
+    // Tiles and sprites only mirror the simulation, so resetting the logic is enough
+    // Walls, goals and dispensers never change, so the cached static layer stays valid
+    simulation.reset();
+    recorder.recordReset(simulation);
+    simulation.saveState(scratchState);
+    history.push(scratchState);
+}
 
-    // Restore tile map
-    if(!initialTileMap.empty()) {
-        tileMap = initialTileMap;
-    } else {
-        Logger::log_debug("No initial tileMap stored; skipping restore.");
+bool Stage::rewind(int turns) {
+    // A rejected rewind leaves the stage as it was, so the replay leaves it out; playback
+    // rewinds through a history of the recorded capacity, where every recorded one succeeds
+    if(!history.rewind(turns, scratchState)) {
+        LOG_INFO("Cannot rewind " + std::to_string(turns) + " turns, only " + std::to_string(history.size()) + " are kept.");
+        return false;
     }
+    simulation.restoreState(scratchState);
+    recorder.recordRewind(simulation, turns);
+    LOG_INFO("Rewound " + std::to_string(turns) + " turns.");
+    return true;
+}
 
-    // Clear current objects and shapes
-    objects.clear();
-    shapes.clear();
+const ReplayRecorder& Stage::getRecorder() const {
+    return recorder;
+}
 
-    // Restore player from initial state
-    if(initialPlayer) {
-        player = std::make_unique<Player>(initialPlayer->posTile, initialPlayer->posWindow, tileSize);
-        Logger::log("Player reset to initial position (" + std::to_string(initialPlayer->posTile.x) + ", " + std::to_string(initialPlayer->posTile.y) + ").");
-    } else {
-        // If no initial player was stored, create default
-        player = std::make_unique<Player>(sf::Vector2i{0,0}, sf::Vector2f{start_x, start_y}, tileSize);
-        Logger::log_debug("No initial player found; created default player at (0,0).");
-    }
 
-    // Clone all initial objects back to objects
-    for(const auto& objPtr : initialObjects) {
-        if(Wall* wall = dynamic_cast<Wall*>(objPtr.get())) {
-            objects.emplace_back(std::make_unique<Wall>(
-                wall->posTile, wall->posWindow, tileSize));
-        } else if(Goal* goal = dynamic_cast<Goal*>(objPtr.get())) {
-            objects.emplace_back(std::make_unique<Goal>(
-                goal->posTile, goal->posWindow, tileSize));
-        } else if(TraceMonster* tm = dynamic_cast<TraceMonster*>(objPtr.get())) {
-            objects.emplace_back(std::make_unique<TraceMonster>(
-                tm->posTile, tm->posWindow, tileSize));
-        } else if(GuardMonster* gm = dynamic_cast<GuardMonster*>(objPtr.get())) {
-            objects.emplace_back(std::make_unique<GuardMonster>(
-                gm->posTile, gm->posWindow, tileSize, gm->getBehaviorPattern()));
-        } else if(Dispenser* disp = dynamic_cast<Dispenser*>(objPtr.get())) {
-            objects.emplace_back(std::make_unique<Dispenser>(
-                disp->posTile, disp->posWindow, tileSize, disp->getBehaviorPattern()));
-        }
+
+// ========== StageLibrary Class =============
+void StageLibrary::load(const std::string& filename) {
+    definitions.clear();
+    Simulation::loadDefinitions(filename, definitions);
+    stages.clear();
+    stages.resize(definitions.size());
+}
+
+void StageLibrary::invalidateStaticLayers() {
+    for(std::unique_ptr<Stage>& stage : stages) {
+        if(stage) stage->invalidateStaticLayer();
     }
+}
 
-    // Recreate visual tiles
-    createTiles();
+size_t StageLibrary::size() const {
+    return definitions.size();
+}
+
+bool StageLibrary::empty() const {
+    return definitions.empty();
+}
 
-    Logger::log("Stage " + std::to_string(stageId) + " reset complete.");
-    print();
-}
\ No newline at end of file
+Stage& StageLibrary::at(size_t index) {
+    std::unique_ptr<Stage>& stage = stages.at(index);
+    if(!stage) {
+        LOG_INFO("Building stage " + std::to_string(definitions[index].stageId) + ".");
+        stage = std::make_unique<Stage>(Simulation(definitions[index]));
+    }
+    return *stage;
+}
@@ -4,19 +4,29 @@
 #include "Logger.hpp"
 #include "Shape.hpp"
 #include "Object.hpp"
+#include "Simulation.hpp"
+#include "Replay.hpp"
+#include "StateHistory.hpp"
 #include <iostream>
 #include <vector>
 #include <memory>
 #include <string>
 #include <queue>
 
+class StageLibrary;
+
+// Rendering layer of a stage.
+// Owns a headless Simulation and only observes it to draw tiles and objects.
 class Stage {
 private:
-    // Starts from 1
-    int stageId;
-    int row;
-    int column;
-    int actionPerTurn;
+    // Game logic of this stage
+    Simulation simulation;
+    // Every action, undo, turn and reset since the stage was built
+    ReplayRecorder recorder;
+    // Recent turns, for rewinding
+    StateHistory history;
+    // Reused to hand states to and from the history, so recording a turn does not allocate
+    WorldState scratchState;
 
     // Hold tile data
     int tileSize;
@@ -24,42 +34,36 @@ private:
     float start_x;
     float start_y;
 
-    // 2D tile map representation
-    std::vector<std::vector<char>> tileMap;
-    // Store all shapes drawn
-    // Use unique_ptr to manage shape memory automatically
-    std::vector<std::unique_ptr<sf::Shape>> shapes;
-    // Store sprites for tiles
-    std::vector<sf::Sprite> tileSprites;
     sf::Sprite backgroundSprite;
 
-    // Store monsters / projectiles / traps in the stage
-    std::vector<std::unique_ptr<Object>> objects;
-    // Buffer for objects to be added or removed during updates
-    std::vector<std::unique_ptr<Object>> bufferObjects;
-    // Store numbers of objects that should be removed
-    std::vector<int> objectsToRemove;
-    // The texture for open space tiles (non-object)
-    sf::Sprite openSpace;
-
-    std::unique_ptr<Player> player;
-    // Record actions by player
-    std::queue<Action> actions;
-
-    // Behavior patterns
-    std::string patternGuardMonster;
-    std::string patternDispenser;
-
-    void handleObjectAction();
-    void handlePlayerAction();
-    bool shouldRemoveProjectile(Projectile* projectile, sf::Vector2i oldPosTile, int i);
-    bool playerIsDead();
-    bool playerReachedGoal();
-
-    // Store initial state for reset
-    std::vector<std::vector<char>> initialTileMap;
-    std::vector<std::unique_ptr<Object>> initialObjects;
-    std::unique_ptr<Player> initialPlayer;
+    // Each layer is drawn with a single draw call, textured from the atlas
+    // Colored tiles under the floor (only visible where a texture is missing)
+    sf::VertexArray tileColorLayer;
+    // Floor texture of every tile, variants chosen once per stage
+    sf::VertexArray floorLayer;
+    // Walls, goals and dispensers never move, so this layer is built once
+    sf::VertexArray staticObjectLayer;
+    // Monsters, arrows and the player, rebuilt every frame without reallocating
+    sf::VertexArray dynamicObjectLayer;
+
+    // Background and every layer above that never changes between turns,
+    // composited once so a frame only draws it as a single quad
+    sf::RenderTexture staticLayer;
+    // World area the static layers cover, the render texture holds exactly this part
+    sf::FloatRect staticBounds;
+    // False if the render texture could not be created, the layers are then drawn directly
+    bool staticLayerAvailable = false;
+    // Set when the cached layer must be composited again
+    bool staticLayerDirty = true;
+
+    void drawStaticLayers(sf::RenderTarget& target);
+    // Composite the static layers at the pixel size they take up on target under its current view
+    void bakeStaticLayer(const sf::RenderTarget& target);
+
+    // Top-left corner of a tile in window coordinates
+    sf::Vector2f tileToWindow(const sf::Vector2i& posTile) const;
+    // Append one atlas tile at a tile position, quarterTurns as in appendTileQuad
+    void appendEntity(sf::VertexArray& layer, AtlasTile tile, const sf::Vector2i& posTile, int quarterTurns = 0);
 
 public:
     // Stage clear overlay
@@ -70,8 +74,8 @@ public:
     static RoundedRectangle buttonRetry;
     static RoundedRectangle buttonNext;
 
-    Stage(int stageId, int column, int row, int actionPerTurn);
-    // Disable copy to avoid double-free of raw shape pointers
+    explicit Stage(Simulation&& simulation);
+    // Stages are only built once and never copied
     Stage(const Stage&) = delete;
     Stage& operator=(const Stage&) = delete;
     // Allow move
@@ -80,13 +84,16 @@ public:
 
     int getRow() const;
     int getColumn() const;
-    Player& getPlayer();
-
-    void setPatternGuardMonster(const std::string& pattern);
-    void setPatternDispenser(const std::string& pattern);
+    const Player& getPlayer() const;
+    Simulation& getSimulation();
+    const ReplayRecorder& getRecorder() const;
 
-    static void createFromFile(std::vector<Stage>& stages);
+    // Load the stage file and set up the shared stage clear overlay
+    static void createFromFile(StageLibrary& stages);
     void createTiles();
+    // Call after a wall, goal or dispenser changed, or the window size or view did
+    // Re-bakes the cached layer on the next draw
+    void invalidateStaticLayer();
 
     void addAction(const Action action);
     bool reachMaxActions() const;
@@ -94,8 +101,31 @@ public:
 
     // Advance by actionPerTurn actions
     void advance(GameState& gameState);
+    // Go back `turns` played turns (resets count as turns too), dropping queued actions
+    // Returns false if the history does not reach that far
+    bool rewind(int turns);
 
     void draw(sf::RenderWindow& window, const GameState& gameState);
     void print() const;
     void reset();
-};
\ No newline at end of file
+};
+
+// Every stage of the stage file.
+// Only the parsed definitions are kept up front: a Stage (simulation, sprites and tiles)
+// is built the first time it is played, so large stage packs load quickly.
+class StageLibrary {
+private:
+    std::vector<StageDefinition> definitions;
+    // Built stages, null until first played
+    std::vector<std::unique_ptr<Stage>> stages;
+
+public:
+    void load(const std::string& filename);
+
+    size_t size() const;
+    bool empty() const;
+    // Index starts from 0, builds the stage on first access
+    Stage& at(size_t index);
+    // Invalidate the static layer of every stage built so far (after the window size or view changed)
+    void invalidateStaticLayers();
+};
@@ -0,0 +1,115 @@
+#include "StageGenerator.hpp"
+#include "Pattern.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // xorshift64*, small and identical everywhere (std:: distributions are not)
+    class Random {
+    private:
+        std::uint64_t state;
+
+    public:
+        explicit Random(std::uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL) {
+            if(state == 0) state = 1;
+        }
+
+        std::uint64_t next() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545F4914F6CDD1DULL;
+        }
+
+        // Uniform in [0, bound)
+        int below(int bound) { return static_cast<int>((next() >> 33) % static_cast<std::uint64_t>(bound)); }
+        // Uniform in [0, 1)
+        double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    };
+
+    std::string randomPattern(Random& random, int length, const char* steps, int stepCount) {
+        std::string pattern;
+        for(int i = 0; i < length; i++) pattern += steps[random.below(stepCount)];
+        return pattern;
+    }
+}
+
+StageDefinition StageGenerator::generate(const GeneratorOptions& options) {
+    StageDefinition definition;
+    definition.stageId = options.stageId;
+    definition.column = std::max(options.column, 2);
+    definition.row = std::max(options.row, 2);
+    definition.actionPerTurn = std::max(options.actionPerTurn, 1);
+    const int column = definition.column;
+    const int row = definition.row;
+    definition.grid.assign(static_cast<std::size_t>(column) * row, SYMBOL_OPEN_SPACE);
+
+    Random random(options.seed);
+    auto at = [&](int x, int y) -> char& { return definition.grid[static_cast<std::size_t>(y) * column + x]; };
+
+    for(char& tile : definition.grid) {
+        if(random.unit() < options.wallDensity) tile = SYMBOL_WALL;
+    }
+    at(0, 0) = SYMBOL_PLAYER;
+    at(column - 1, row - 1) = SYMBOL_GOAL;
+
+    // Free tiles, shuffled once and handed out in order, so dense maps never retry
+    // The player's neighbors stay free, the player must not die before its first move
+    std::vector<int> freeTiles;
+    for(int y = 0; y < row; y++) {
+        for(int x = 0; x < column; x++) {
+            if(x + y > 1 && at(x, y) == SYMBOL_OPEN_SPACE) freeTiles.push_back(y * column + x);
+        }
+    }
+    for(int i = static_cast<int>(freeTiles.size()) - 1; i > 0; i--) {
+        std::swap(freeTiles[i], freeTiles[random.below(i + 1)]);
+    }
+
+    std::size_t nextFree = 0;
+    auto place = [&](char symbol, int count) {
+        for(int i = 0; i < count && nextFree < freeTiles.size(); i++) {
+            definition.grid[freeTiles[nextFree++]] = symbol;
+        }
+    };
+    place(SYMBOL_TRACE_MONSTER, options.traceMonsters);
+    place(SYMBOL_GUARD_MONSTER, options.guardMonsters);
+    place(SYMBOL_DISPENSER, options.dispensers);
+
+    // Patterns are handed out in map order, one per entity
+    static const char MOVES[] = {SYMBOL_UP, SYMBOL_DOWN, SYMBOL_LEFT, SYMBOL_RIGHT, 'X'};
+    const int patternLength = std::max(options.patternLength, 1);
+    for(char tile : definition.grid) {
+        if(tile == SYMBOL_GUARD_MONSTER) {
+            definition.guardMonsterPatterns.push_back(randomPattern(random, patternLength, MOVES, 5));
+        } else if(tile == SYMBOL_DISPENSER) {
+            definition.dispenserPatterns.push_back(randomPattern(random, patternLength, MOVES, 5));
+        }
+    }
+    return definition;
+}
+
+void StageGenerator::appendStageText(std::string& out, const StageDefinition& definition) {
+    out += "STAGE_START\nSTAGE_ID: " + std::to_string(definition.stageId)
+        + "\nCOLUMN: " + std::to_string(definition.column)
+        + "\nROW: " + std::to_string(definition.row)
+        + "\nACTION_PER_TURN: " + std::to_string(definition.actionPerTurn)
+        + "\nPATTERN_START\n";
+    // Like stages.txt, a list is only written for entities that exist
+    if(!definition.dispenserPatterns.empty()) {
+        out += "DISPENSER: ";
+        for(const std::string& pattern : definition.dispenserPatterns) out += pattern + ";";
+        out += '\n';
+    }
+    if(!definition.guardMonsterPatterns.empty()) {
+        out += "GUARD_MONSTER: ";
+        for(const std::string& pattern : definition.guardMonsterPatterns) out += pattern + ";";
+        out += '\n';
+    }
+    out += "PATTERN_END\nMAP_START\n";
+    for(int y = 0; y < definition.row; y++) {
+        out.append(&definition.grid[static_cast<std::size_t>(y) * definition.column], definition.column);
+        out += '\n';
+    }
+    out += "MAP_END\nSTAGE_END\n\n";
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "StageParser.hpp"
+#include <cstdint>
+#include <string>
+
+// What a generated stage contains
+struct GeneratorOptions {
+    int stageId = 1;
+    int column = 50;
+    int row = 50;
+    int actionPerTurn = 1;
+    // Share of the tiles that become walls, 0 to 1
+    double wallDensity = 0.1;
+    int traceMonsters = 10;
+    int guardMonsters = 10;
+    int dispensers = 5;
+    // Steps per generated guard monster and dispenser pattern
+    int patternLength = 8;
+    std::uint64_t seed = 1;
+};
+
+// Synthetic stages for stress tests and benchmarks.
+// The same options and seed always give the same stage, on every platform, so a slow stage
+// can be named by its options alone. The player starts in the top-left corner and the goal
+// is in the opposite one; everything else is scattered over the free tiles.
+class StageGenerator {
+public:
+    // Entities that do not fit on the free tiles are left out (the definition then has fewer)
+    static StageDefinition generate(const GeneratorOptions& options);
+
+    // Stage file text of a definition, a STAGE_START ... STAGE_END block as in stages.txt
+    static void appendStageText(std::string& out, const StageDefinition& definition);
+
+private:
+    // Hide constructors to prevent instantiation
+    StageGenerator() = delete;
+    ~StageGenerator() = delete;
+};
@@ -0,0 +1,510 @@
+#include "StageParser.hpp"
+#include "MappedFile.hpp"
+#include "Pattern.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+    using Severity = ParseDiagnostic::Severity;
+
+    // Positions are stored as 16-bit coordinates in WorldState
+    const int MAX_DIMENSION = 32767;
+    // Pattern cursors are stored as 16-bit values in WorldState
+    const long long MAX_PATTERN_LENGTH = 65535;
+    const int MAX_ACTION_PER_TURN = 1000;
+
+    // Splits the mapped file into lines without copying them
+    class LineReader {
+    private:
+        const char* current;
+        const char* end;
+        int number = 0;
+
+    public:
+        LineReader(const char* data, size_t size) : current(data), end(data + size) {}
+
+        bool next(std::string_view& line) {
+            if(current >= end) return false;
+            const char* newline = static_cast<const char*>(std::memchr(current, '\n', end - current));
+            const char* lineEnd = newline ? newline : end;
+            line = std::string_view(current, lineEnd - current);
+            // Accept files saved with Windows line endings
+            if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            current = newline ? newline + 1 : end;
+            number++;
+            return true;
+        }
+
+        int lineNumber() const { return number; }
+    };
+
+    std::string_view trimView(std::string_view text) {
+        size_t first = text.find_first_not_of(" \t");
+        if(first == std::string_view::npos) return text.substr(text.size());
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    bool isTileSymbol(char ch) {
+        return ch == SYMBOL_PLAYER || ch == SYMBOL_GOAL || ch == SYMBOL_WALL || ch == SYMBOL_OPEN_SPACE
+            || ch == SYMBOL_DISPENSER || ch == SYMBOL_TRACE_MONSTER || ch == SYMBOL_GUARD_MONSTER;
+    }
+
+    bool isPatternStep(char ch) {
+        // 'X' is a step that does nothing
+        return ch == SYMBOL_UP || ch == SYMBOL_DOWN || ch == SYMBOL_LEFT || ch == SYMBOL_RIGHT || ch == 'X';
+    }
+
+    bool isDigit(char ch) {
+        return ch >= '0' && ch <= '9';
+    }
+
+    std::string quoted(std::string_view text) {
+        return "'" + std::string(text) + "'";
+    }
+
+    enum class Section {
+        Header,
+        Patterns,
+        // After PATTERN_END, before MAP_START
+        BeforeMap,
+        Map,
+        // After MAP_END, before STAGE_END
+        AfterMap,
+    };
+
+    class Parser {
+    private:
+        LineReader reader;
+        std::vector<StageDefinition>& stages;
+        std::vector<ParseDiagnostic>& diagnostics;
+        // Stage id -> line of its STAGE_START
+        std::unordered_map<int, int> stageLines;
+
+        // State of the stage being parsed
+        std::string_view line;
+        StageDefinition stage;
+        bool stageHasError = false;
+        unsigned seenHeaderKeys = 0;
+        bool mapUsable = false;
+        int mapRow = 0;
+        bool tooManyRows = false;
+        int playerLine = 0;
+
+        void report(Severity severity, int lineNumber, int column, std::string message) {
+            diagnostics.push_back({severity, lineNumber, column, std::move(message)});
+            if(severity == Severity::Error) stageHasError = true;
+        }
+
+        void report(Severity severity, int column, std::string message) {
+            report(severity, reader.lineNumber(), column, std::move(message));
+        }
+
+        // 1-based column of a view into the current line
+        int columnOf(std::string_view text) const {
+            return static_cast<int>(text.data() - line.data()) + 1;
+        }
+
+        // Returns true when the stage ended at a new STAGE_START that still has to be parsed
+        bool parseStage();
+        void parseHeaderLine(std::string_view text);
+        void parsePatternLine(std::string_view text);
+        void parsePatternList(std::string_view value, std::vector<std::string>& patterns);
+        void parseDispenserPatternList(std::string_view value, std::vector<std::string>& patterns);
+        void beginMap();
+        void parseMapRow();
+        void endMap();
+        void finishStage();
+
+    public:
+        Parser(const char* data, size_t size, std::vector<StageDefinition>& stages,
+            std::vector<ParseDiagnostic>& diagnostics) :
+            reader(data, size), stages(stages), diagnostics(diagnostics) {}
+
+        void run() {
+            bool pendingStart = false;
+            while(pendingStart || reader.next(line)) {
+                pendingStart = false;
+                std::string_view text = trimView(line);
+                if(text.empty()) continue;
+                if(text == "STAGE_START") {
+                    pendingStart = parseStage();
+                    continue;
+                }
+                report(Severity::Warning, columnOf(text), "text outside of a STAGE_START ... STAGE_END block is ignored");
+            }
+        }
+    };
+
+    bool Parser::parseStage() {
+        stage = StageDefinition();
+        stage.line = reader.lineNumber();
+        stageHasError = false;
+        seenHeaderKeys = 0;
+        mapUsable = false;
+        mapRow = 0;
+        tooManyRows = false;
+        playerLine = 0;
+        bool seenMap = false;
+        Section section = Section::Header;
+
+        while(reader.next(line)) {
+            std::string_view text = trimView(line);
+
+            if(text == "STAGE_START") {
+                report(Severity::Error, stage.line, 0, "missing STAGE_END, stage is skipped");
+                return true;
+            }
+            if(text == "STAGE_END") {
+                if(section == Section::Patterns) {
+                    report(Severity::Error, 0, "missing PATTERN_END before STAGE_END");
+                } else if(section == Section::Map) {
+                    report(Severity::Error, 0, "missing MAP_END before STAGE_END");
+                }
+                if(!seenMap) {
+                    report(Severity::Error, 0, "stage has no MAP_START ... MAP_END block");
+                }
+                finishStage();
+                return false;
+            }
+
+            switch(section) {
+                case Section::Header:
+                    if(text.empty()) break;
+                    if(text == "PATTERN_START") {
+                        section = Section::Patterns;
+                    } else if(text == "MAP_START") {
+                        beginMap();
+                        seenMap = true;
+                        section = Section::Map;
+                    } else {
+                        parseHeaderLine(text);
+                    }
+                    break;
+
+                case Section::Patterns:
+                    if(text.empty()) break;
+                    if(text == "PATTERN_END") {
+                        section = Section::BeforeMap;
+                    } else if(text == "MAP_START") {
+                        report(Severity::Error, 0, "missing PATTERN_END before MAP_START");
+                        beginMap();
+                        seenMap = true;
+                        section = Section::Map;
+                    } else {
+                        parsePatternLine(text);
+                    }
+                    break;
+
+                case Section::BeforeMap:
+                    if(text.empty()) break;
+                    if(text == "MAP_START") {
+                        beginMap();
+                        seenMap = true;
+                        section = Section::Map;
+                    } else {
+                        report(Severity::Warning, columnOf(text), "expected MAP_START, line is ignored");
+                    }
+                    break;
+
+                case Section::Map:
+                    if(text == "MAP_END") {
+                        endMap();
+                        section = Section::AfterMap;
+                    } else if(!line.empty() && line.substr(0, 2) != "##") { // '##' starts a comment
+                        parseMapRow();
+                    }
+                    break;
+
+                case Section::AfterMap:
+                    if(text.empty()) break;
+                    report(Severity::Warning, columnOf(text), "expected STAGE_END, line is ignored");
+                    break;
+            }
+        }
+
+        report(Severity::Error, stage.line, 0, "missing STAGE_END at end of file, stage is skipped");
+        return false;
+    }
+
+    void Parser::parseHeaderLine(std::string_view text) {
+        size_t colon = text.find(':');
+        if(colon == std::string_view::npos) {
+            report(Severity::Error, columnOf(text), "expected 'KEY: value', PATTERN_START or MAP_START, got " + quoted(text));
+            return;
+        }
+        std::string_view key = trimView(text.substr(0, colon));
+        std::string_view value = trimView(text.substr(colon + 1));
+
+        int* target = nullptr;
+        int maximum = INT_MAX;
+        unsigned keyBit = 0;
+        if(key == "STAGE_ID") {
+            target = &stage.stageId;
+            keyBit = 1;
+        } else if(key == "COLUMN") {
+            target = &stage.column;
+            maximum = MAX_DIMENSION;
+            keyBit = 2;
+        } else if(key == "ROW") {
+            target = &stage.row;
+            maximum = MAX_DIMENSION;
+            keyBit = 4;
+        } else if(key == "ACTION_PER_TURN") {
+            target = &stage.actionPerTurn;
+            maximum = MAX_ACTION_PER_TURN;
+            keyBit = 8;
+        } else {
+            report(Severity::Warning, columnOf(key), "unknown header key " + quoted(key) + " is ignored");
+            return;
+        }
+
+        if(seenHeaderKeys & keyBit) {
+            report(Severity::Warning, columnOf(key), "duplicate " + std::string(key) + ", the last value is used");
+        }
+        seenHeaderKeys |= keyBit;
+
+        int number = 0;
+        const char* valueEnd = value.data() + value.size();
+        std::from_chars_result result = std::from_chars(value.data(), valueEnd, number);
+        if(value.empty() || result.ec != std::errc() || result.ptr != valueEnd) {
+            report(Severity::Error, columnOf(value), "expected a whole number for " + std::string(key) + ", got " + quoted(value));
+            return;
+        }
+        if(number < 1 || number > maximum) {
+            report(Severity::Error, columnOf(value), std::string(key) + " must be between 1 and " + std::to_string(maximum)
+                + ", got " + std::to_string(number));
+            return;
+        }
+        *target = number;
+    }
+
+    void Parser::parsePatternLine(std::string_view text) {
+        size_t colon = text.find(':');
+        std::string_view key = trimView(text.substr(0, colon));
+        if(colon == std::string_view::npos || (key != "DISPENSER" && key != "GUARD_MONSTER")) {
+            report(Severity::Warning, columnOf(text), "expected 'DISPENSER: ...' or 'GUARD_MONSTER: ...', line is ignored");
+            return;
+        }
+
+        const bool dispenser = key == "DISPENSER";
+        std::vector<std::string>& patterns = dispenser ? stage.dispenserPatterns : stage.guardMonsterPatterns;
+        if(!patterns.empty()) {
+            report(Severity::Warning, columnOf(key), "duplicate " + std::string(key) + " patterns, the last line is used");
+            patterns.clear();
+        }
+        if(dispenser) {
+            parseDispenserPatternList(trimView(text.substr(colon + 1)), patterns);
+        } else {
+            parsePatternList(trimView(text.substr(colon + 1)), patterns);
+        }
+    }
+
+    // e.g. "U2D2;LX;" -> {"UUDD", "LX"}, one pattern per entity
+    void Parser::parsePatternList(std::string_view value, std::vector<std::string>& patterns) {
+        size_t segmentStart = 0;
+        long long segmentLength = 0;
+        // Steps contributed by the last step letter, and its repeat count so far (-1 before any digit)
+        long long current = 0;
+        long long repeat = -1;
+        bool segmentValid = true;
+
+        auto closeSegment = [&](size_t segmentEnd) {
+            std::string_view segment = value.substr(segmentStart, segmentEnd - segmentStart);
+            if(segmentValid && segmentLength > MAX_PATTERN_LENGTH) {
+                report(Severity::Error, columnOf(segment), "pattern expands to " + std::to_string(segmentLength)
+                    + " steps, at most " + std::to_string(MAX_PATTERN_LENGTH) + " are allowed");
+                segmentValid = false;
+            }
+            patterns.push_back(segmentValid ? processPattern(std::string(segment)) : std::string());
+            segmentStart = segmentEnd + 1;
+            segmentLength = 0;
+            current = 0;
+            repeat = -1;
+            segmentValid = true;
+        };
+
+        for(size_t i = 0; i < value.size(); i++) {
+            char ch = value[i];
+            if(ch == ';') {
+                closeSegment(i);
+            } else if(isPatternStep(ch)) {
+                segmentLength++;
+                current = 1;
+                repeat = -1;
+            } else if(isDigit(ch)) {
+                if(i == segmentStart) {
+                    report(Severity::Error, columnOf(value.substr(i)), "repeat count must follow a step");
+                    segmentValid = false;
+                    continue;
+                }
+                // "U12" replaces the single U already counted by 12 of them
+                // Clamped so that huge counts are still reported instead of overflowing
+                repeat = std::min((repeat < 0 ? 0 : repeat) * 10 + (ch - '0'), MAX_PATTERN_LENGTH + 1);
+                segmentLength += repeat - current;
+                current = repeat;
+            } else {
+                report(Severity::Error, columnOf(value.substr(i)), "unknown pattern step " + quoted(value.substr(i, 1))
+                    + " (expected U, D, L, R, X, a repeat count or ';')");
+                segmentValid = false;
+            }
+        }
+        // A missing trailing ';' still ends the last pattern
+        if(segmentStart < value.size()) closeSegment(value.size());
+    }
+
+    // Dispenser patterns are used as written, as the stage loader always took them: no repeat
+    // counts, and any other character is a step that fires nothing
+    void Parser::parseDispenserPatternList(std::string_view value, std::vector<std::string>& patterns) {
+        size_t segmentStart = 0;
+        for(size_t i = 0; i <= value.size(); i++) {
+            if(i < value.size() && value[i] != ';') {
+                if(!isPatternStep(value[i])) {
+                    report(Severity::Warning, columnOf(value.substr(i)), "dispenser step " + quoted(value.substr(i, 1))
+                        + " is not U, D, L, R or X and fires nothing");
+                }
+                continue;
+            }
+            // A missing trailing ';' still ends the last pattern
+            if(i == value.size() && segmentStart == value.size()) break;
+
+            std::string_view segment = value.substr(segmentStart, i - segmentStart);
+            if(static_cast<long long>(segment.size()) > MAX_PATTERN_LENGTH) {
+                report(Severity::Error, columnOf(segment), "pattern has " + std::to_string(segment.size())
+                    + " steps, at most " + std::to_string(MAX_PATTERN_LENGTH) + " are allowed");
+                patterns.emplace_back();
+            } else {
+                patterns.emplace_back(segment);
+            }
+            segmentStart = i + 1;
+        }
+    }
+
+    void Parser::beginMap() {
+        if(!(seenHeaderKeys & 1)) report(Severity::Error, 0, "missing STAGE_ID before MAP_START");
+        if(!(seenHeaderKeys & 2)) report(Severity::Error, 0, "missing COLUMN before MAP_START");
+        if(!(seenHeaderKeys & 4)) report(Severity::Error, 0, "missing ROW before MAP_START");
+
+        mapUsable = stage.column > 0 && stage.row > 0;
+        if(mapUsable) {
+            stage.grid.assign(static_cast<size_t>(stage.row) * stage.column, SYMBOL_OPEN_SPACE);
+        }
+    }
+
+    void Parser::parseMapRow() {
+        if(!mapUsable) return;
+        if(mapRow >= stage.row) {
+            if(!tooManyRows) {
+                report(Severity::Error, 0, "map has more than ROW (" + std::to_string(stage.row) + ") rows");
+                tooManyRows = true;
+            }
+            return;
+        }
+
+        int width = static_cast<int>(line.size());
+        if(width > stage.column) {
+            report(Severity::Warning, stage.column + 1, "row is " + std::to_string(width) + " tiles wide, COLUMN is "
+                + std::to_string(stage.column) + ", the rest is ignored");
+            width = stage.column;
+        } else if(width < stage.column) {
+            report(Severity::Warning, width + 1, "row is " + std::to_string(width) + " tiles wide, COLUMN is "
+                + std::to_string(stage.column) + ", the rest is filled with '-'");
+        }
+
+        char* tiles = stage.grid.data() + static_cast<size_t>(mapRow) * stage.column;
+        for(int c = 0; c < width; c++) {
+            char ch = line[c];
+            if(!isTileSymbol(ch)) {
+                report(Severity::Error, c + 1, "unknown tile symbol " + quoted(line.substr(c, 1)));
+                continue;
+            }
+            if(ch == SYMBOL_PLAYER) {
+                if(playerLine > 0) {
+                    report(Severity::Error, c + 1, "second player start, the first one is on line " + std::to_string(playerLine));
+                }
+                playerLine = reader.lineNumber();
+            }
+            tiles[c] = ch;
+        }
+        mapRow++;
+    }
+
+    void Parser::endMap() {
+        if(!mapUsable) return;
+        if(mapRow < stage.row) {
+            report(Severity::Warning, 0, "map has " + std::to_string(mapRow) + " rows, ROW is " + std::to_string(stage.row)
+                + ", the rest is filled with '-'");
+        }
+        if(playerLine == 0) {
+            report(Severity::Warning, 0, "map has no player start 'P', the player starts at (0, 0)");
+        }
+
+        // Patterns are handed out to entities in map order
+        size_t guardMonsters = 0;
+        size_t dispensers = 0;
+        for(char ch : stage.grid) {
+            if(ch == SYMBOL_GUARD_MONSTER) guardMonsters++;
+            else if(ch == SYMBOL_DISPENSER) dispensers++;
+        }
+        auto checkCount = [&](const char* name, size_t entities, size_t patterns) {
+            if(patterns < entities) {
+                report(Severity::Warning, 0, std::to_string(entities) + " " + name + "s but only " + std::to_string(patterns)
+                    + " patterns, the rest stand still");
+            } else if(patterns > entities) {
+                report(Severity::Warning, 0, std::to_string(patterns) + " " + name + " patterns but only "
+                    + std::to_string(entities) + " " + name + "s, the rest are unused");
+            }
+        };
+        checkCount("GUARD_MONSTER", guardMonsters, stage.guardMonsterPatterns.size());
+        checkCount("DISPENSER", dispensers, stage.dispenserPatterns.size());
+    }
+
+    void Parser::finishStage() {
+        if(stageHasError) return;
+
+        auto inserted = stageLines.emplace(stage.stageId, stage.line);
+        if(!inserted.second) {
+            report(Severity::Error, stage.line, 0, "duplicate STAGE_ID " + std::to_string(stage.stageId)
+                + ", first used by the stage on line " + std::to_string(inserted.first->second));
+            return;
+        }
+        stages.emplace_back(std::move(stage));
+    }
+}
+
+bool StageParser::parseFile(const std::string& filename, std::vector<StageDefinition>& stages,
+    std::vector<ParseDiagnostic>& diagnostics) {
+    MappedFile file;
+    if(!file.open(filename)) {
+        diagnostics.push_back({ParseDiagnostic::Severity::Error, 0, 0, "cannot open file"});
+        return false;
+    }
+    return parse(file.data(), file.size(), stages, diagnostics);
+}
+
+bool StageParser::parse(const char* data, size_t size, std::vector<StageDefinition>& stages,
+    std::vector<ParseDiagnostic>& diagnostics) {
+    size_t firstDiagnostic = diagnostics.size();
+    Parser(data, size, stages, diagnostics).run();
+
+    for(size_t i = firstDiagnostic; i < diagnostics.size(); i++) {
+        if(diagnostics[i].severity == ParseDiagnostic::Severity::Error) return false;
+    }
+    return true;
+}
+
+std::string StageParser::format(const std::string& filename, const ParseDiagnostic& diagnostic) {
+    std::string text = filename;
+    if(diagnostic.line > 0) {
+        text += ":" + std::to_string(diagnostic.line);
+        if(diagnostic.column > 0) text += ":" + std::to_string(diagnostic.column);
+    }
+    text += diagnostic.severity == ParseDiagnostic::Severity::Error ? ": error: " : ": warning: ";
+    text += diagnostic.message;
+    return text;
+}
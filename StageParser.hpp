@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Everything a stage file says about one stage, before any game object is built from it.
+// Cheap to keep for every stage of a pack; Simulation and Stage are only built when needed.
+struct StageDefinition {
+    // Starts from 1
+    int stageId = 0;
+    int column = 0;
+    int row = 0;
+    int actionPerTurn = 1;
+    // Row-major, row * column symbols as written in the map
+    std::vector<char> grid;
+    // Behavior patterns, one per entity in map order
+    // Guard monster patterns are expanded (e.g. U2D2 -> UUDD), dispenser patterns are kept as written
+    std::vector<std::string> guardMonsterPatterns;
+    std::vector<std::string> dispenserPatterns;
+    // Line of STAGE_START in the stage file
+    int line = 0;
+
+    char tileAt(int x, int y) const { return grid[y * column + x]; }
+};
+
+// A problem found in a stage file, pointing at the offending text
+struct ParseDiagnostic {
+    enum class Severity {
+        // The stage is still loaded, with the described fallback
+        Warning,
+        // The stage is left out
+        Error,
+    };
+
+    Severity severity;
+    // 1-based
+    int line;
+    // 1-based, 0 when the whole line is concerned
+    int column;
+    std::string message;
+};
+
+// Single-pass parser for stage files (see stages.txt for the format).
+// The file is memory-mapped and scanned in place; only the resulting definitions are allocated.
+class StageParser {
+public:
+    // Parse every STAGE_START ... STAGE_END block of a file
+    // Returns false if the file cannot be read or any error was reported
+    static bool parseFile(const std::string& filename, std::vector<StageDefinition>& stages,
+        std::vector<ParseDiagnostic>& diagnostics);
+    // Same for a file already in memory
+    static bool parse(const char* data, size_t size, std::vector<StageDefinition>& stages,
+        std::vector<ParseDiagnostic>& diagnostics);
+
+    // e.g. "stages.txt:12:7: error: unknown tile symbol 'Q'"
+    static std::string format(const std::string& filename, const ParseDiagnostic& diagnostic);
+
+private:
+    // Hide constructors to prevent instantiation
+    StageParser() = delete;
+    ~StageParser() = delete;
+};
@@ -0,0 +1,106 @@
+#include "StateHistory.hpp"
+#include <algorithm>
+
+namespace {
+    bool sameEntity(const EntityState& a, const EntityState& b) {
+        return a.x == b.x && a.y == b.y && a.kind == b.kind && a.direction == b.direction && a.cursor == b.cursor;
+    }
+}
+
+StateHistory::StateHistory(int capacity, int keyframeInterval) :
+    capacity(std::max(capacity, 1)), keyframeInterval(std::max(keyframeInterval, 1)),
+    deltas(this->capacity), keyframes(this->capacity / this->keyframeInterval + 2) {}
+
+void StateHistory::reset(const WorldState& state) {
+    newestTurn = 0;
+    count = 0;
+    newest = state;
+    for(Keyframe& keyframe : keyframes) keyframe.turn = -1;
+    keyframeSlot(0) = {0, state};
+}
+
+StateHistory::Keyframe& StateHistory::keyframeSlot(long long turn) {
+    return keyframes[(turn / keyframeInterval) % static_cast<long long>(keyframes.size())];
+}
+
+void StateHistory::push(const WorldState& state) {
+    // The delta restores what `newest` looked like before this turn
+    TurnDelta& delta = deltas[(newestTurn + 1) % capacity];
+    delta.hash = newest.hash;
+    delta.playerX = newest.playerX;
+    delta.playerY = newest.playerY;
+    delta.entityCount = static_cast<std::uint32_t>(newest.entities.size());
+    delta.changed.clear();
+    for(std::size_t i = 0; i < newest.entities.size(); i++) {
+        if(i >= state.entities.size() || !sameEntity(newest.entities[i], state.entities[i])) {
+            delta.changed.push_back({static_cast<std::uint32_t>(i), newest.entities[i]});
+        }
+    }
+
+    newest = state;
+    newestTurn++;
+    count = std::min(count + 1, capacity);
+
+    if(newestTurn % keyframeInterval == 0) {
+        Keyframe& keyframe = keyframeSlot(newestTurn);
+        keyframe.turn = newestTurn;
+        keyframe.state = state;
+    }
+}
+
+int StateHistory::size() const {
+    return count;
+}
+
+int StateHistory::getCapacity() const {
+    return capacity;
+}
+
+void StateHistory::applyDelta(const TurnDelta& delta, WorldState& state) {
+    state.hash = delta.hash;
+    state.playerX = delta.playerX;
+    state.playerY = delta.playerY;
+    // Entities past the old count are gone, and every old index past the new count is in changed
+    state.entities.resize(delta.entityCount);
+    for(const ChangedEntity& changed : delta.changed) {
+        state.entities[changed.index] = changed.state;
+    }
+}
+
+bool StateHistory::rewind(int turns, WorldState& result) {
+    if(turns < 0 || turns > count) return false;
+    const long long target = newestTurn - turns;
+
+    // Walk back from the newest state, or from the first keyframe past the target if it is closer
+    long long from = newestTurn;
+    const WorldState* start = &newest;
+    long long firstKeyframe = (target + keyframeInterval - 1) / keyframeInterval * keyframeInterval;
+    if(firstKeyframe < newestTurn) {
+        const Keyframe& keyframe = keyframeSlot(firstKeyframe);
+        if(keyframe.turn == firstKeyframe) {
+            from = firstKeyframe;
+            start = &keyframe.state;
+        }
+    }
+
+    result = *start;
+    for(long long t = from; t > target; t--) {
+        applyDelta(deltas[t % capacity], result);
+    }
+
+    // The rewound turns are gone, newer keyframes with them
+    for(Keyframe& keyframe : keyframes) {
+        if(keyframe.turn > target) keyframe.turn = -1;
+    }
+    newest = result;
+    newestTurn = target;
+    count -= turns;
+    return true;
+}
+
+std::size_t StateHistory::memoryUsage() const {
+    std::size_t bytes = sizeof(*this) + newest.entities.capacity() * sizeof(EntityState);
+    for(const TurnDelta& delta : deltas) bytes += sizeof(TurnDelta) + delta.changed.capacity() * sizeof(ChangedEntity);
+    for(const Keyframe& keyframe : keyframes) bytes += sizeof(Keyframe) + keyframe.state.entities.capacity() * sizeof(EntityState);
+    return bytes;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "WorldState.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded turn history for rewinding a stage.
+//
+// Each recorded turn keeps a backward delta: the player, hash and only those entities that
+// changed in that turn, with their values from before it. Rewinding n turns applies n deltas
+// to the newest state. Every keyframeInterval turns a full state is also kept, and a rewind
+// starts from the nearest keyframe at or after its target when that is closer, so any rewind
+// costs at most about keyframeInterval deltas.
+//
+// The oldest turns are dropped once capacity is reached. Slots are reused, so once the ring
+// is full and entity counts have settled, recording a turn no longer allocates.
+// Tiles are not recorded: walls, goals and dispensers never change, and what stands on a tile
+// follows from the entities.
+class StateHistory {
+public:
+    static constexpr int DEFAULT_CAPACITY = 1024;
+    static constexpr int DEFAULT_KEYFRAME_INTERVAL = 32;
+
+    explicit StateHistory(int capacity = DEFAULT_CAPACITY, int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Forget every turn, state becomes the newest (and only) one
+    void reset(const WorldState& state);
+    // Record one more turn that ended in state
+    void push(const WorldState& state);
+
+    // Turns that can be rewound
+    int size() const;
+    // Most turns kept
+    int getCapacity() const;
+    // State `turns` turns before the newest one (at most size()); those turns are dropped
+    // Returns false and leaves result alone if there are not that many
+    bool rewind(int turns, WorldState& result);
+
+    // Bytes held by deltas and keyframes, bounded by capacity
+    std::size_t memoryUsage() const;
+
+private:
+    struct ChangedEntity {
+        std::uint32_t index;
+        EntityState state;
+    };
+
+    // How to get from the state after turn t back to the state after turn t - 1
+    struct TurnDelta {
+        std::uint64_t hash = 0;
+        std::int16_t playerX = 0;
+        std::int16_t playerY = 0;
+        std::uint32_t entityCount = 0;
+        std::vector<ChangedEntity> changed;
+    };
+
+    struct Keyframe {
+        // -1 while the slot is unused
+        long long turn = -1;
+        WorldState state;
+    };
+
+    int capacity;
+    int keyframeInterval;
+    // Turn number of the newest state, counting every push since the last reset
+    long long newestTurn = 0;
+    int count = 0;
+    WorldState newest;
+
+    // Delta of turn t is in deltas[t % capacity]
+    std::vector<TurnDelta> deltas;
+    // Keyframe of turn t (a multiple of keyframeInterval) is in keyframes[(t / keyframeInterval) % size]
+    std::vector<Keyframe> keyframes;
+
+    Keyframe& keyframeSlot(long long turn);
+    static void applyDelta(const TurnDelta& delta, WorldState& state);
+};
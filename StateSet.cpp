@@ -0,0 +1,65 @@
+#include "StateSet.hpp"
+
+namespace {
+    constexpr std::size_t INITIAL_SLOTS = 64;
+}
+
+std::size_t StateSet::slotOf(const std::vector<Entry>& entries, std::uint64_t hash) {
+    // The top bits picked the shard, the low bits are still evenly spread
+    std::size_t mask = entries.size() - 1;
+    std::size_t slot = static_cast<std::size_t>(hash) & mask;
+    while(entries[slot].reached != 0 && entries[slot].hash != hash) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void StateSet::grow(Shard& shard) {
+    std::size_t oldBytes = shard.entries.size() * sizeof(Entry);
+    std::vector<Entry> old(shard.entries.empty() ? INITIAL_SLOTS : shard.entries.size() * 2, Entry{0, 0});
+    old.swap(shard.entries);
+    for(const Entry& entry : old) {
+        if(entry.reached != 0) shard.entries[slotOf(shard.entries, entry.hash)] = entry;
+    }
+    totalBytes += shard.entries.size() * sizeof(Entry) - oldBytes;
+}
+
+bool StateSet::offer(std::uint64_t hash, std::uint32_t level, std::uint64_t order) {
+    std::uint64_t reached = (static_cast<std::uint64_t>(level) + 1) << ORDER_BITS | (order & ORDER_MASK);
+    Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Keep the load under 3/4 so probe chains stay short
+    if((shard.count + 1) * 4 > shard.entries.size() * 3) grow(shard);
+
+    Entry& entry = shard.entries[slotOf(shard.entries, hash)];
+    if(entry.reached == 0) {
+        entry = {hash, reached};
+        shard.count++;
+        totalCount++;
+        return true;
+    }
+    // Same depth and a smaller order is a smaller value, anything from an earlier depth is smaller still
+    if(reached < entry.reached) entry.reached = reached;
+    return false;
+}
+
+bool StateSet::find(std::uint64_t hash, std::uint32_t& level, std::uint64_t& order) const {
+    const Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if(shard.entries.empty()) return false;
+
+    const Entry& entry = shard.entries[slotOf(shard.entries, hash)];
+    if(entry.reached == 0) return false;
+    level = static_cast<std::uint32_t>((entry.reached >> ORDER_BITS) - 1);
+    order = entry.reached & ORDER_MASK;
+    return true;
+}
+
+std::size_t StateSet::size() const {
+    return totalCount;
+}
+
+std::size_t StateSet::memoryUsage() const {
+    return totalBytes + sizeof(StateSet);
+}
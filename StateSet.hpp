@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Visited set of a breadth-first search that many threads fill at once, keyed by Zobrist hash.
+//
+// The hashes are split over SHARD_COUNT shards by their top bits, and each shard is an
+// open-addressing table behind its own lock, so threads only wait for each other when two of
+// them touch the same shard at the same moment.
+//
+// Every entry remembers the depth it was first reached at and, among all the moves that
+// reached it at that depth, the one with the smallest order number. Which thread gets there
+// first changes from run to run, the smallest order does not, so a search that takes its
+// parent links from here finds the same path every time.
+class StateSet {
+public:
+    static constexpr int SHARD_BITS = 10;
+    static constexpr int SHARD_COUNT = 1 << SHARD_BITS;
+
+    StateSet() = default;
+    StateSet(const StateSet&) = delete;
+    StateSet& operator=(const StateSet&) = delete;
+
+    // Record that hash was reached at depth `level` by the move numbered `order`.
+    // Returns true only the first time hash is seen; a later offer at the same depth with a
+    // smaller order replaces the order, one at a greater depth changes nothing.
+    bool offer(std::uint64_t hash, std::uint32_t level, std::uint64_t order);
+    // Depth and smallest order hash was reached with, false if it was never offered
+    bool find(std::uint64_t hash, std::uint32_t& level, std::uint64_t& order) const;
+
+    std::size_t size() const;
+    // Bytes held by the tables
+    std::size_t memoryUsage() const;
+
+private:
+    // Orders have 40 bits, the depth (plus one, so 0 means empty) sits above them
+    static constexpr int ORDER_BITS = 40;
+    static constexpr std::uint64_t ORDER_MASK = (std::uint64_t{1} << ORDER_BITS) - 1;
+
+    struct Entry {
+        std::uint64_t hash;
+        std::uint64_t reached;
+    };
+
+    // Own cache line each, so neighboring locks do not bounce between cores
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+        std::size_t count = 0;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<std::size_t> totalCount{0};
+    std::atomic<std::size_t> totalBytes{0};
+
+    // Slot that holds hash, or the empty slot it belongs in (entries is never full)
+    static std::size_t slotOf(const std::vector<Entry>& entries, std::uint64_t hash);
+    void grow(Shard& shard);
+};
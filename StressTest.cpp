@@ -0,0 +1,314 @@
+// Stress stages and scaling report.
+// "generate" writes synthetic stages at any size, wall density and entity mix as a stage file.
+// "report" builds such stages along a sweep of one parameter at a time, plays turns headlessly
+// and shows how turn time and memory grow, flagging anything that grows faster than linear.
+//
+// Usage: stresstest generate [stage options] [--stages K] [-o FILE]
+//        stresstest report [stage options] [--vary PARAM]... [--turns T] [--csv FILE]
+// Stage options: --size WxH --walls DENSITY --trace N --guard N --dispensers N
+//                --pattern-length N --action-per-turn N --seed S
+// PARAM: size, walls, trace, guard, dispensers
+#include "Types.hpp"
+#include "Simulation.hpp"
+#include "StageGenerator.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Parameters a report can sweep
+enum class Parameter {
+    Size,
+    Walls,
+    TraceMonsters,
+    GuardMonsters,
+    Dispensers,
+};
+
+const char* parameterName(Parameter parameter) {
+    switch(parameter) {
+        case Parameter::Size: return "size";
+        case Parameter::Walls: return "walls";
+        case Parameter::TraceMonsters: return "trace";
+        case Parameter::GuardMonsters: return "guard";
+        case Parameter::Dispensers: return "dispensers";
+    }
+    return "";
+}
+
+bool parseParameter(const std::string& name, Parameter& parameter) {
+    for(Parameter candidate : {Parameter::Size, Parameter::Walls, Parameter::TraceMonsters, Parameter::GuardMonsters, Parameter::Dispensers}) {
+        if(name == parameterName(candidate)) {
+            parameter = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Values each parameter is swept over, everything else stays at the base options
+std::vector<double> sweepValues(Parameter parameter) {
+    switch(parameter) {
+        case Parameter::Size: return {25, 50, 100, 200, 500};
+        case Parameter::Walls: return {0.0, 0.1, 0.2, 0.3, 0.4};
+        case Parameter::TraceMonsters: return {10, 30, 100, 300, 1000};
+        case Parameter::GuardMonsters: return {10, 30, 100, 300, 1000};
+        case Parameter::Dispensers: return {5, 15, 50, 150, 500};
+    }
+    return {};
+}
+
+GeneratorOptions withParameter(GeneratorOptions options, Parameter parameter, double value) {
+    switch(parameter) {
+        case Parameter::Size: options.column = options.row = static_cast<int>(value); break;
+        case Parameter::Walls: options.wallDensity = value; break;
+        case Parameter::TraceMonsters: options.traceMonsters = static_cast<int>(value); break;
+        case Parameter::GuardMonsters: options.guardMonsters = static_cast<int>(value); break;
+        case Parameter::Dispensers: options.dispensers = static_cast<int>(value); break;
+    }
+    return options;
+}
+
+// Amount of work a parameter value stands for: a size of n means n * n tiles
+double workOf(Parameter parameter, double value) {
+    return parameter == Parameter::Size ? value * value : value;
+}
+
+struct SamplePoint {
+    double value;
+    double meanNs;
+    double p50Ns;
+    double p99Ns;
+    // Heap held by the built stage, and the most it held while playing
+    std::int64_t stageBytes;
+    std::int64_t peakBytes;
+    int deaths;
+};
+
+SamplePoint runPoint(const GeneratorOptions& options, int turns) {
+    StageDefinition definition = StageGenerator::generate(options);
+
+    std::int64_t before = AllocationTracker::getLiveBytes();
+    Simulation simulation(definition);
+    std::int64_t built = AllocationTracker::getLiveBytes();
+    AllocationTracker::resetPeak();
+
+    // The player waits in its corner, so the monsters come and the arrows keep flying
+    std::vector<double> durations;
+    durations.reserve(turns);
+    int deaths = 0;
+    for(int turn = 0; turn < turns; turn++) {
+        auto begin = Clock::now();
+        for(int i = 0; i < simulation.getActionPerTurn(); i++) {
+            TurnResult result = simulation.step(Action::None);
+            if(result == TurnResult::PlayerDied) {
+                deaths++;
+                simulation.reset();
+                break;
+            }
+            if(result == TurnResult::StageCleared) break;
+        }
+        durations.push_back(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+    }
+
+    SamplePoint point{};
+    double total = 0.0;
+    for(double duration : durations) total += duration;
+    std::sort(durations.begin(), durations.end());
+    point.meanNs = total / durations.size();
+    point.p50Ns = durations[(durations.size() - 1) * 50 / 100];
+    point.p99Ns = durations[(durations.size() - 1) * 99 / 100];
+    point.stageBytes = built - before;
+    point.peakBytes = AllocationTracker::getPeakBytes() - before;
+    point.deaths = deaths;
+    return point;
+}
+
+// Growth exponent between two points: 1 is linear, 2 quadratic
+double exponent(double workA, double costA, double workB, double costB) {
+    if(workA <= 0.0 || workB <= workA || costA <= 0.0 || costB <= 0.0) return NAN;
+    return std::log(costB / costA) / std::log(workB / workA);
+}
+
+// Exponents above this are reported as superlinear
+const double SUPERLINEAR = 1.15;
+const int PLOT_WIDTH = 40;
+
+void report(const GeneratorOptions& base, const std::vector<Parameter>& parameters, int turns, FILE* csv) {
+    if(csv) std::fprintf(csv, "parameter,value,mean_ns,p50_ns,p99_ns,stage_bytes,peak_bytes,deaths\n");
+
+    for(Parameter parameter : parameters) {
+        std::printf("\n== %s (base %dx%d, walls %.2f, trace %d, guard %d, dispensers %d, %d turns)\n",
+            parameterName(parameter), base.column, base.row, base.wallDensity, base.traceMonsters,
+            base.guardMonsters, base.dispensers, turns);
+        std::printf("%10s %12s %12s %12s %12s %12s %7s  %s\n", "value", "mean us", "p50 us", "p99 us",
+            "stage KiB", "peak KiB", "exp", "mean turn time");
+
+        std::vector<SamplePoint> points;
+        for(double value : sweepValues(parameter)) {
+            SamplePoint point = runPoint(withParameter(base, parameter, value), turns);
+            point.value = value;
+            points.push_back(point);
+            if(csv) {
+                std::fprintf(csv, "%s,%g,%.0f,%.0f,%.0f,%lld,%lld,%d\n", parameterName(parameter), value, point.meanNs,
+                    point.p50Ns, point.p99Ns, static_cast<long long>(point.stageBytes), static_cast<long long>(point.peakBytes), point.deaths);
+            }
+        }
+
+        double longest = 0.0;
+        for(const SamplePoint& point : points) longest = std::max(longest, point.meanNs);
+        bool superlinear = false;
+        for(std::size_t i = 0; i < points.size(); i++) {
+            const SamplePoint& point = points[i];
+            // Local exponent against the previous point (not meaningful for wall density)
+            double local = NAN;
+            if(i > 0 && parameter != Parameter::Walls) {
+                local = exponent(workOf(parameter, points[i - 1].value), points[i - 1].meanNs,
+                    workOf(parameter, point.value), point.meanNs);
+            }
+            bool flagged = !std::isnan(local) && local > SUPERLINEAR;
+            superlinear = superlinear || flagged;
+
+            int bar = longest > 0.0 ? static_cast<int>(std::lround(point.meanNs / longest * PLOT_WIDTH)) : 0;
+            char exponentText[16];
+            if(std::isnan(local)) std::snprintf(exponentText, sizeof(exponentText), "-");
+            else std::snprintf(exponentText, sizeof(exponentText), "%.2f%s", local, flagged ? "!" : "");
+            std::printf("%10g %12.1f %12.1f %12.1f %12.1f %12.1f %7s  %s\n", point.value, point.meanNs / 1000.0,
+                point.p50Ns / 1000.0, point.p99Ns / 1000.0, point.stageBytes / 1024.0, point.peakBytes / 1024.0,
+                exponentText, std::string(bar, '#').c_str());
+        }
+
+        if(parameter != Parameter::Walls) {
+            double overall = exponent(workOf(parameter, points.front().value), points.front().meanNs,
+                workOf(parameter, points.back().value), points.back().meanNs);
+            std::printf("overall exponent %.2f%s\n", overall,
+                superlinear ? "  <- superlinear growth (marked '!'), worth a profile" : "");
+        }
+        std::fflush(stdout);
+    }
+}
+
+bool parseSize(const char* text, int& column, int& row) {
+    const char* separator = std::strchr(text, 'x');
+    column = std::atoi(text);
+    row = separator ? std::atoi(separator + 1) : column;
+    return column > 0 && row > 0;
+}
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s generate [stage options] [--stages K] [-o FILE]\n"
+        "       %s report [stage options] [--vary PARAM]... [--turns T] [--csv FILE]\n"
+        "Stage options: --size WxH --walls DENSITY --trace N --guard N --dispensers N\n"
+        "               --pattern-length N --action-per-turn N --seed S\n"
+        "PARAM: size, walls, trace, guard, dispensers (default: all of them)\n", program, program);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2 || (std::strcmp(argv[1], "generate") != 0 && std::strcmp(argv[1], "report") != 0)) {
+        printUsage(argv[0]);
+        return argc < 2 ? 0 : 2;
+    }
+    const bool generating = std::strcmp(argv[1], "generate") == 0;
+
+    GeneratorOptions options;
+    options.column = options.row = 100;
+    int stages = 1;
+    int turns = 200;
+    std::string outputFile;
+    std::string csvFile;
+    std::vector<Parameter> parameters;
+
+    for(int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        i++;
+        if(arg == "--size") {
+            if(!parseSize(value, options.column, options.row)) {
+                std::fprintf(stderr, "Invalid size '%s'\n", value);
+                return 2;
+            }
+        } else if(arg == "--walls") {
+            options.wallDensity = std::atof(value);
+        } else if(arg == "--trace") {
+            options.traceMonsters = std::atoi(value);
+        } else if(arg == "--guard") {
+            options.guardMonsters = std::atoi(value);
+        } else if(arg == "--dispensers") {
+            options.dispensers = std::atoi(value);
+        } else if(arg == "--pattern-length") {
+            options.patternLength = std::atoi(value);
+        } else if(arg == "--action-per-turn") {
+            options.actionPerTurn = std::atoi(value);
+        } else if(arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if(arg == "--stages" && generating) {
+            stages = std::max(1, std::atoi(value));
+        } else if(arg == "-o" && generating) {
+            outputFile = value;
+        } else if(arg == "--vary" && !generating) {
+            Parameter parameter;
+            if(!parseParameter(value, parameter)) {
+                std::fprintf(stderr, "Unknown parameter '%s'\n", value);
+                return 2;
+            }
+            parameters.push_back(parameter);
+        } else if(arg == "--turns" && !generating) {
+            turns = std::max(1, std::atoi(value));
+        } else if(arg == "--csv" && !generating) {
+            csvFile = value;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(generating) {
+        // Consecutive seeds, so a pack of K stages is K different maps
+        std::string text;
+        const std::uint64_t firstSeed = options.seed;
+        for(int i = 0; i < stages; i++) {
+            options.stageId = i + 1;
+            options.seed = firstSeed + i;
+            StageGenerator::appendStageText(text, StageGenerator::generate(options));
+        }
+        FILE* out = outputFile.empty() ? stdout : std::fopen(outputFile.c_str(), "w");
+        if(!out) {
+            std::fprintf(stderr, "Cannot write %s\n", outputFile.c_str());
+            return 2;
+        }
+        std::fwrite(text.data(), 1, text.size(), out);
+        if(out != stdout) std::fclose(out);
+        return 0;
+    }
+
+    if(parameters.empty()) {
+        parameters = {Parameter::Size, Parameter::Walls, Parameter::TraceMonsters, Parameter::GuardMonsters, Parameter::Dispensers};
+    }
+    FILE* csv = nullptr;
+    if(!csvFile.empty()) {
+        csv = std::fopen(csvFile.c_str(), "w");
+        if(!csv) {
+            std::fprintf(stderr, "Cannot write %s\n", csvFile.c_str());
+            return 2;
+        }
+    }
+    report(options, parameters, turns, csv);
+    if(csv) std::fclose(csv);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "TileGrid.hpp"
+
+TileGrid::TileGrid(int column, int row) :
+    column(column), row(row), stride(column + 2),
+    cells(static_cast<std::size_t>(column + 2) * (row + 2), BORDER),
+    layers((cells.size() + 63) / 64 * TILE_LAYER_COUNT, 0),
+    monsterCounts(cells.size(), 0), arrowCounts(cells.size(), 0),
+    neighborOffsets{-(column + 2), column + 2, -1, 1} {
+    // Everything starts as border wall, then the inside is opened up
+    for(int i = 0; i < static_cast<int>(cells.size()); i++) {
+        setLayer(TileLayer::Wall, i, true);
+    }
+    for(int y = 0; y < row; y++) {
+        for(int x = 0; x < column; x++) {
+            setTile(x, y, SYMBOL_OPEN_SPACE);
+        }
+    }
+}
+
+void TileGrid::setLayer(TileLayer layer, int index, bool value) {
+    std::uint64_t bit = std::uint64_t{1} << (index & 63);
+    if(value) layerWord(layer, index) |= bit;
+    else layerWord(layer, index) &= ~bit;
+}
+
+int TileGrid::directionOffset(char direction) const {
+    if(direction == SYMBOL_UP) return neighborOffsets[0];
+    if(direction == SYMBOL_DOWN) return neighborOffsets[1];
+    if(direction == SYMBOL_LEFT) return neighborOffsets[2];
+    if(direction == SYMBOL_RIGHT) return neighborOffsets[3];
+    return 0;
+}
+
+void TileGrid::setTile(int x, int y, char symbol) {
+    int i = index(x, y);
+    // Only walls, dispensers and goals are part of the stage itself
+    if(symbol != SYMBOL_WALL && symbol != SYMBOL_DISPENSER && symbol != SYMBOL_GOAL) symbol = SYMBOL_OPEN_SPACE;
+    cells[i] = symbol;
+    setLayer(TileLayer::Wall, i, symbol == SYMBOL_WALL);
+    setLayer(TileLayer::Dispenser, i, symbol == SYMBOL_DISPENSER);
+    setLayer(TileLayer::Goal, i, symbol == SYMBOL_GOAL);
+}
+
+void TileGrid::place(TileLayer layer, int index) {
+    if(countOf(layer, index)++ == 0) setLayer(layer, index, true);
+}
+
+void TileGrid::lift(TileLayer layer, int index) {
+    if(--countOf(layer, index) == 0) setLayer(layer, index, false);
+}
+
+int TileGrid::countAt(TileLayer layer, int index) const {
+    return layer == TileLayer::Monster ? monsterCounts[index] : arrowCounts[index];
+}
+
+bool TileGrid::operator==(const TileGrid& other) const {
+    return column == other.column && row == other.row && cells == other.cells && layers == other.layers
+        && monsterCounts == other.monsterCounts && arrowCounts == other.arrowCounts;
+}
+
+bool TileGrid::operator!=(const TileGrid& other) const {
+    return !(*this == other);
+}
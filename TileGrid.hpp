@@ -0,0 +1,126 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "Types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Occupancy layers of a tile. Walls, dispensers and goals come from the stage and never change;
+// monsters and arrows move, and any number of them may share a tile without hiding each other.
+enum class TileLayer : std::uint8_t {
+    Wall,
+    Dispenser,
+    Goal,
+    Monster,
+    Arrow,
+};
+constexpr int TILE_LAYER_COUNT = 5;
+
+// Set of layers, one bit per TileLayer
+using TileLayerMask = std::uint8_t;
+constexpr TileLayerMask layerMask(TileLayer layer) {
+    return static_cast<TileLayerMask>(1u << static_cast<int>(layer));
+}
+
+// Tile map of a stage, stored row-major and surrounded by a one-tile wall border.
+// Every neighbor of a tile inside the map is a real cell, so stepping to a neighbor is one index add
+// and the border stops movement exactly like a wall, without any bounds checks.
+// Cell indices count the border; positions are tile coordinates inside the map as before.
+//
+// What stands on a cell is kept in one bitboard per layer. The words of all layers for the same
+// 64 cells are stored next to each other, so a test over several layers reads one cache line.
+class TileGrid {
+private:
+    int column = 0;
+    int row = 0;
+    // Cells per buffer row, including the two border columns
+    int stride = 2;
+    // Stage symbol of every cell (wall, dispenser, goal or open space), only for drawing and debug output
+    std::vector<char> cells;
+    // TILE_LAYER_COUNT words per 64 cells
+    std::vector<std::uint64_t> layers;
+    // Monsters and arrows per cell, their layer bit is set while the count is not zero
+    std::vector<std::uint16_t> monsterCounts;
+    std::vector<std::uint16_t> arrowCounts;
+    // Index offsets to the Up, Down, Left and Right neighbor
+    std::array<int, 4> neighborOffsets = {-2, 2, -1, 1};
+
+    std::uint64_t& layerWord(TileLayer layer, int index) {
+        return layers[(index >> 6) * TILE_LAYER_COUNT + static_cast<int>(layer)];
+    }
+    std::uint16_t& countOf(TileLayer layer, int index) {
+        return layer == TileLayer::Monster ? monsterCounts[index] : arrowCounts[index];
+    }
+    // Set or clear one layer bit of a cell
+    void setLayer(TileLayer layer, int index, bool value);
+
+public:
+    // Symbol of the border cells
+    static constexpr char BORDER = SYMBOL_WALL;
+    // Up, Down, Left, Right (same order as the A* and distance field neighbors)
+    static constexpr int NEIGHBOR_COUNT = 4;
+    static constexpr int NEIGHBOR_DX[NEIGHBOR_COUNT] = {0, 0, -1, 1};
+    static constexpr int NEIGHBOR_DY[NEIGHBOR_COUNT] = {-1, 1, 0, 0};
+
+    // Nothing may move onto these
+    static constexpr TileLayerMask BLOCKING = layerMask(TileLayer::Wall) | layerMask(TileLayer::Dispenser);
+    // The player dies on these
+    static constexpr TileLayerMask DANGEROUS = layerMask(TileLayer::Monster) | layerMask(TileLayer::Arrow);
+    // Any layer at all (a cell with none of these is open space)
+    static constexpr TileLayerMask OCCUPIED = BLOCKING | DANGEROUS | layerMask(TileLayer::Goal);
+
+    TileGrid() = default;
+    // Map of column x row open tiles inside a wall border
+    TileGrid(int column, int row);
+
+    int getColumn() const { return column; }
+    int getRow() const { return row; }
+    int getStride() const { return stride; }
+    // Number of cells including the border (valid indices are [0, getCellCount()))
+    std::size_t getCellCount() const { return cells.size(); }
+
+    // Whether pos is inside the map (the border is not)
+    bool contains(const sf::Vector2i& pos) const {
+        return pos.x >= 0 && pos.x < column && pos.y >= 0 && pos.y < row;
+    }
+
+    // Cell index of a position inside the map or on the border around it
+    int index(int x, int y) const { return (y + 1) * stride + (x + 1); }
+    int index(const sf::Vector2i& pos) const { return index(pos.x, pos.y); }
+    sf::Vector2i position(int index) const { return {index % stride - 1, index / stride - 1}; }
+
+    const std::array<int, 4>& getNeighborOffsets() const { return neighborOffsets; }
+    // Index offset of a direction symbol (SYMBOL_UP, ...), 0 for anything else
+    int directionOffset(char direction) const;
+
+    // Stage symbol of a cell: SYMBOL_WALL, SYMBOL_DISPENSER, SYMBOL_GOAL or SYMBOL_OPEN_SPACE
+    char operator[](int index) const { return cells[index]; }
+    char at(int x, int y) const { return cells[index(x, y)]; }
+    char at(const sf::Vector2i& pos) const { return cells[index(pos)]; }
+    // Set the stage symbol of a tile and its static layer (monsters and the player are not tiles)
+    void setTile(int x, int y, char symbol);
+
+    bool has(TileLayer layer, int index) const {
+        return (layers[(index >> 6) * TILE_LAYER_COUNT + static_cast<int>(layer)] >> (index & 63)) & 1u;
+    }
+    // Whether any layer of mask is set on the cell, one OR per layer and a single AND
+    bool hasAny(TileLayerMask mask, int index) const {
+        const std::uint64_t* words = &layers[(index >> 6) * TILE_LAYER_COUNT];
+        std::uint64_t combined = 0;
+        for(int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+            if(mask & (1u << layer)) combined |= words[layer];
+        }
+        return (combined >> (index & 63)) & 1u;
+    }
+    bool hasAny(TileLayerMask mask, const sf::Vector2i& pos) const { return hasAny(mask, index(pos)); }
+
+    // A monster or arrow enters or leaves a cell (only TileLayer::Monster and TileLayer::Arrow)
+    void place(TileLayer layer, int index);
+    void lift(TileLayer layer, int index);
+    // Number of monsters or arrows on a cell
+    int countAt(TileLayer layer, int index) const;
+
+    bool operator==(const TileGrid& other) const;
+    bool operator!=(const TileGrid& other) const;
+};
@@ -0,0 +1,97 @@
+#include "Logger.hpp"
+#include "TrajectoryTable.hpp"
+
+std::int64_t TrajectoryTable::GuardTrajectory::key(int index, int cursor) const {
+    std::int64_t period = pattern && !pattern->empty() ? static_cast<std::int64_t>(pattern->size()) : 1;
+    return index * period + cursor;
+}
+
+TrajectoryTable::TrajectoryTable(const TileGrid& tileMap, const EntityStore& entities) {
+    static const std::vector<char> NO_STEPS;
+    const PatternedEntities& guardMonsters = entities.guardMonsters;
+    guards.resize(guardMonsters.size());
+
+    for(int i = 0; i < guardMonsters.size(); i++) {
+        GuardTrajectory& trajectory = guards[i];
+        trajectory.pattern = guardMonsters.patterns[i];
+        const std::vector<char>& steps = trajectory.pattern ? *trajectory.pattern : NO_STEPS;
+
+        int index = tileMap.index(guardMonsters.positions[i]);
+        int cursor = guardMonsters.cursors[i];
+        // Walk until a state comes back, from then on the guard repeats itself
+        while(static_cast<int>(trajectory.indices.size()) < MAX_GUARD_STATES) {
+            auto seen = trajectory.turnOf.find(trajectory.key(index, cursor));
+            if(seen != trajectory.turnOf.end()) {
+                trajectory.loopStart = seen->second;
+                break;
+            }
+            trajectory.turnOf.emplace(trajectory.key(index, cursor), static_cast<int>(trajectory.indices.size()));
+            trajectory.indices.push_back(index);
+            trajectory.cursors.push_back(static_cast<std::uint16_t>(cursor));
+            stepGuard(tileMap, steps, index, cursor);
+        }
+
+        if(trajectory.loopStart < 0) {
+            LOG_INFO("GuardMonster " + std::to_string(i) + " does not repeat within "
+                + std::to_string(MAX_GUARD_STATES) + " turns, later turns are stepped.");
+        }
+    }
+
+    const PatternedEntities& dispensers = entities.dispensers;
+    dispenserShots.resize(dispensers.size());
+    for(int i = 0; i < dispensers.size(); i++) {
+        if(!dispensers.hasPattern(i)) continue;
+        const int index = tileMap.index(dispensers.positions[i]);
+        for(char direction : *dispensers.patterns[i]) {
+            int offset = tileMap.directionOffset(direction);
+            // Stage tiles never free up, so a shot at one of them never happens
+            bool possible = offset != 0 && !tileMap.hasAny(TileGrid::BLOCKING | layerMask(TileLayer::Goal), index + offset);
+            dispenserShots[i].push_back(possible ? direction : 0);
+        }
+    }
+}
+
+void TrajectoryTable::stepGuard(const TileGrid& tileMap, const std::vector<char>& pattern, int& index, int& cursor) {
+    if(pattern.empty()) return;
+    int next = index + tileMap.directionOffset(pattern[cursor]);
+    // A blocked step is retried next turn, and the wall is still there then
+    if(tileMap.hasAny(TileGrid::BLOCKING, next)) return;
+    index = next;
+    if(++cursor == static_cast<int>(pattern.size())) cursor = 0;
+}
+
+void TrajectoryTable::guardStateAt(const TileGrid& tileMap, int guard, int index, int cursor, int turns,
+    int& resultIndex, int& resultCursor) const {
+    static const std::vector<char> NO_STEPS;
+    const GuardTrajectory& trajectory = guards[guard];
+    const std::vector<char>& steps = trajectory.pattern ? *trajectory.pattern : NO_STEPS;
+    const int recorded = static_cast<int>(trajectory.indices.size());
+
+    auto found = trajectory.turnOf.find(trajectory.key(index, cursor));
+    if(found != trajectory.turnOf.end()) {
+        std::int64_t turn = static_cast<std::int64_t>(found->second) + turns;
+        if(turn >= recorded && trajectory.loopStart >= 0) {
+            turn = trajectory.loopStart + (turn - trajectory.loopStart) % (recorded - trajectory.loopStart);
+        }
+        if(turn < recorded) {
+            resultIndex = trajectory.indices[turn];
+            resultCursor = trajectory.cursors[turn];
+            return;
+        }
+        // Past the end of a walk that was cut off, continue from its last state
+        turns = static_cast<int>(turn - (recorded - 1));
+        index = trajectory.indices[recorded - 1];
+        cursor = trajectory.cursors[recorded - 1];
+    }
+
+    // Not a state of the recorded walk, fall back to stepping
+    for(int t = 0; t < turns; t++) stepGuard(tileMap, steps, index, cursor);
+    resultIndex = index;
+    resultCursor = cursor;
+}
+
+char TrajectoryTable::dispenserShotAt(int dispenser, int cursor, int turns) const {
+    const std::vector<char>& shots = dispenserShots[dispenser];
+    if(shots.empty()) return 0;
+    return shots[(static_cast<std::int64_t>(cursor) + turns) % static_cast<std::int64_t>(shots.size())];
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "Pattern.hpp"
+#include "TileGrid.hpp"
+#include "EntityStore.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Precomputed futures of guard monsters and dispensers, built once per stage.
+//
+// A guard monster only waits when its next step runs into a wall, a dispenser or the border,
+// none of which ever move, so its whole walk is fixed by the stage: it either settles into a loop
+// of its pattern or gets stuck against a wall for good. The walk from the stage start is recorded
+// up to the point it repeats, and any later turn is an index into that record.
+// A dispenser fires its pattern in a fixed cycle; only the spawn tile being taken can stop a shot.
+class TrajectoryTable {
+public:
+    // Upper bound on recorded states per guard, a longer walk is stepped on demand past it
+    static constexpr int MAX_GUARD_STATES = 1 << 16;
+
+    TrajectoryTable() = default;
+    TrajectoryTable(const TileGrid& tileMap, const EntityStore& entities);
+
+    // Cell index and cursor of guard monster i `turns` actor passes after it stands on index with cursor
+    void guardStateAt(const TileGrid& tileMap, int guard, int index, int cursor, int turns,
+        int& resultIndex, int& resultCursor) const;
+    // Direction dispenser i tries to fire `turns` actor passes after its cursor is `cursor`,
+    // 0 if the pattern step is not a direction or points at a wall, dispenser or goal.
+    // A monster or arrow on the spawn tile may still stop a shot reported here
+    char dispenserShotAt(int dispenser, int cursor, int turns) const;
+
+private:
+    struct GuardTrajectory {
+        CompiledPattern pattern;
+        // Cell and cursor after every actor pass from the stage start
+        std::vector<int> indices;
+        std::vector<std::uint16_t> cursors;
+        // States from loopStart on repeat forever (a stuck guard loops over a single state)
+        // -1 if the walk was cut off at MAX_GUARD_STATES before it repeated
+        int loopStart = -1;
+        // Turn each recorded state is reached, keyed by index * pattern size + cursor
+        std::unordered_map<std::int64_t, int> turnOf;
+
+        std::int64_t key(int index, int cursor) const;
+    };
+
+    std::vector<GuardTrajectory> guards;
+    // Shot per pattern step of every dispenser, 0 where it cannot fire
+    std::vector<std::vector<char>> dispenserShots;
+
+    // One actor pass of a guard monster, the same rule as EntityStore::updateGuardMonster
+    static void stepGuard(const TileGrid& tileMap, const std::vector<char>& pattern, int& index, int& cursor);
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+// Game types shared by the simulation and the rendering layer.
+// Nothing here depends on SFML graphics, so headless tools can include it.
+
+enum class Action {
+    MoveUp,
+    MoveDown,
+    MoveLeft,
+    MoveRight,
+    Attack,
+    None,
+};
+
+// Object symbols
+inline const char SYMBOL_PLAYER = 'P';
+inline const char SYMBOL_GOAL = 'G';
+inline const char SYMBOL_WALL = 'X';
+inline const char SYMBOL_OPEN_SPACE = '-';
+inline const char SYMBOL_DISPENSER = 'D';
+inline const char SYMBOL_TRACE_MONSTER = 'M';
+inline const char SYMBOL_GUARD_MONSTER = 'm';
+inline const char SYMBOL_ARROW = 'A';
+
+// Direction symbols
+inline const char SYMBOL_UP = 'U';
+inline const char SYMBOL_DOWN = 'D';
+inline const char SYMBOL_LEFT = 'L';
+inline const char SYMBOL_RIGHT = 'R';
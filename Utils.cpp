@@ -37,27 +37,27 @@ void handleDrag(const sf::RenderWindow& window, sf::View& view, sf::Vector2i& la
         // Ensure the View center stays within [0, WORLD_WIDTH] and [0, WORLD_HEIGHT]
         
         // Restrict X to [0, WORLD_WIDTH], Y to [0, WORLD_HEIGHT]
-        float newCenterX = clamp(targetX, 0.0f, WORLD_WIDTH);
-        float newCenterY = clamp(targetY, 0.0f, WORLD_HEIGHT);
+        float newCenterX = clamp(targetX, 0.0f, Config::WORLD_WIDTH);
+        float newCenterY = clamp(targetY, 0.0f, Config::WORLD_HEIGHT);
         view.setCenter({newCenterX, newCenterY});
 
         lastMousePos = currentMousePos;
         
-        Logger::log_debug("View moved to (" + std::to_string(view.getCenter().x) + ", " + std::to_string(view.getCenter().y) + ")");
+        LOG_DEBUG("View moved to (" + std::to_string(view.getCenter().x) + ", " + std::to_string(view.getCenter().y) + ")");
 }
 
 void handleScroll(sf::View& view, const sf::Event::MouseWheelScrolled* mouseWheel) {
     //  > 0 meaning zoom in and restrict max/min zoom levels
     if(mouseWheel->delta > 0 && view.getSize().x > 500.f && view.getSize().y > 500.f) {
         // 1.0 - 0.1 = 0.9
-        view.zoom(1.0f - ZOOM_RATE);
-        Logger::log_debug("Zoomed in.");
-        Logger::log_debug("View size: (" + std::to_string(view.getSize().x) + ", " + std::to_string(view.getSize().y) + ").");
-    } else if(mouseWheel->delta < 0 && view.getSize().x < WORLD_WIDTH * 2.f && view.getSize().y < WORLD_HEIGHT * 2.f) {
+        view.zoom(1.0f - Config::ZOOM_RATE);
+        LOG_DEBUG("Zoomed in.");
+        LOG_DEBUG("View size: (" + std::to_string(view.getSize().x) + ", " + std::to_string(view.getSize().y) + ").");
+    } else if(mouseWheel->delta < 0 && view.getSize().x < Config::WORLD_WIDTH * 2.f && view.getSize().y < Config::WORLD_HEIGHT * 2.f) {
         // 1.0 + 0.1 = 1.1
-        view.zoom(1.0f + ZOOM_RATE);
-        Logger::log_debug("Zoomed out.");
-        Logger::log_debug("View size: (" + std::to_string(view.getSize().x) + ", " + std::to_string(view.getSize().y) + ").");
+        view.zoom(1.0f + Config::ZOOM_RATE);
+        LOG_DEBUG("Zoomed out.");
+        LOG_DEBUG("View size: (" + std::to_string(view.getSize().x) + ", " + std::to_string(view.getSize().y) + ").");
     }
 }
 
@@ -65,8 +65,8 @@ void setBackground(sf::Sprite& backgroundSprite, const sf::Texture& backgroundTe
     // Original size of the background texture
     sf::Vector2u backgroundSize = backgroundTexture.getSize();
     
-    float viewWidth = WORLD_WIDTH;
-    float viewHeight = WORLD_HEIGHT; 
+    float viewWidth = Config::WORLD_WIDTH;
+    float viewHeight = Config::WORLD_HEIGHT; 
     
     // 1. Calculate scaling factor
     // Must use the larger scale (Cover mode)
@@ -85,41 +85,7 @@ void setBackground(sf::Sprite& backgroundSprite, const sf::Texture& backgroundTe
     backgroundSprite.setPosition({viewWidth / 2.f, viewHeight / 2.f});
     backgroundSprite.setColor(color);
 
-    Logger::log_debug("Background set.");
-}
-
-// Process pattern: expand letters with numbers (e.g. U2D2L4 -> UUDDLLLL)
-std::string processPattern(const std::string& pattern) {
-    std::string expandedPattern;
-    for(int i = 0; i < pattern.size(); i++) {
-        char ch = pattern[i];
-        if(std::isalpha(ch)) {
-            // Check if followed by a digit
-            if(i + 1 < pattern.size() && std::isdigit(pattern[i + 1])) {
-                int repeatCount = pattern[i + 1] - '0';
-                // Handle multi-digit numbers
-                int j = i + 2;
-                while(j < pattern.size() && std::isdigit(pattern[j])) {
-                    repeatCount = repeatCount * 10 + (pattern[j] - '0');
-                    j++;
-                }
-                // Skip the digits
-                i = j - 1;
-                // Repeat the character
-                for(int k = 0; k < repeatCount; k++) {
-                    expandedPattern += ch;
-                }
-            } else {
-                // No number after letter, add once
-                expandedPattern += ch;
-            }
-        } else if(!std::isdigit(ch)) {
-            // Keep non-alphanumeric characters (like semicolons)
-            expandedPattern += ch;
-        }
-    }
-    
-    return expandedPattern;
+    LOG_DEBUG("Background set.");
 }
 
 void resizeTileTexture(sf::Sprite& sprite, int tile_size) {
@@ -129,35 +95,6 @@ void resizeTileTexture(sf::Sprite& sprite, int tile_size) {
     sprite.setScale({scaleX, scaleY});
 }
 
-// Remove leading and trailing spaces from a string
-std::string trim(const std::string& str) {
-    size_t first = str.find_first_not_of(' ');
-    if (std::string::npos == first) return str;
-    size_t last = str.find_last_not_of(' ');
-    return str.substr(first, (last - first + 1));
-}
-
-// Cycle pattern string: move first character to the end
-void cyclePattern(std::string& pattern) {
-    if(pattern.empty()) {
-        Logger::log_debug("Warning: Attempted to cycle an empty pattern string.");
-        return;
-    }
-
-    // Get the first character
-    char firstChar = pattern[0];
-
-    // Remove the first character from the beginning of the string
-    // The parameters of erase() are the starting iterator and ending iterator.
-    // pattern.begin() points to the first character, pattern.begin() + 1 points to the second character.
-    pattern.erase(pattern.begin()); 
-
-    // Append the character to the end of the string
-    pattern += firstChar;
-
-    Logger::log_debug("Pattern cycled: " + pattern);
-}
-
 // Return 1~4 (Has a higher probability to return 1)
 int getVariantNumber() {
     int randValue = rand() % 100;
@@ -165,4 +102,26 @@ int getVariantNumber() {
     else if(randValue < 80) return 2;
     else if(randValue < 90) return 3;
     else return 4;
-}
\ No newline at end of file
+}
+
+void appendTileQuad(sf::VertexArray& layer, sf::Vector2f position, float size, const sf::IntRect& textureRect,
+    sf::Color color, int quarterTurns) {
+    // Corners clockwise from the top-left
+    const sf::Vector2f corners[4] = {
+        position,
+        {position.x + size, position.y},
+        {position.x + size, position.y + size},
+        {position.x, position.y + size},
+    };
+    float left = static_cast<float>(textureRect.position.x);
+    float top = static_cast<float>(textureRect.position.y);
+    float right = left + textureRect.size.x;
+    float bottom = top + textureRect.size.y;
+    const sf::Vector2f texCoords[4] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+
+    // Turning clockwise hands every corner the texture corner before it
+    int turns = ((quarterTurns % 4) + 4) % 4;
+    for(int corner : {0, 1, 2, 0, 2, 3}) {
+        layer.append(sf::Vertex{corners[corner], color, texCoords[(corner - turns + 4) % 4]});
+    }
+}
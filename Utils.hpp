@@ -1,6 +1,7 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "Constants.hpp"
+#include "Pattern.hpp"
 #include <vector>
 #include <string>
 
@@ -8,8 +9,9 @@ float clamp(float value, float min, float max);
 void handleDrag(const sf::RenderWindow& window, sf::View& view, sf::Vector2i& lastMousePos);
 void handleScroll(sf::View& view, const sf::Event::MouseWheelScrolled* mouseWheel);
 void setBackground(sf::Sprite& backgroundSprite, const sf::Texture& backgroundTexture, sf::Color color = BACKGROUND_TRANSLUCENT);
-std::string processPattern(const std::string& pattern);
 void resizeTileTexture(sf::Sprite& sprite, int tile_size);
-std::string trim(const std::string& str);
-void cyclePattern(std::string& pattern);
-int getVariantNumber();
\ No newline at end of file
+int getVariantNumber();
+// Append a square tile as two triangles to a layer drawn with sf::PrimitiveType::Triangles
+// quarterTurns rotates the texture clockwise by multiples of 90 degrees
+void appendTileQuad(sf::VertexArray& layer, sf::Vector2f position, float size, const sf::IntRect& textureRect,
+    sf::Color color = sf::Color::White, int quarterTurns = 0);
\ No newline at end of file
@@ -0,0 +1,265 @@
+// Consistency checks of the precomputed lookups and the state encoding against stepped play.
+// Every stage of a stage file, and a set of generated stages, is played with random input.
+// From many points along the way the lookups are asked about the coming actions, and each
+// answer is compared with what stepping a copy of the simulation actually does.
+// Mismatches are printed and make the exit code 1.
+//
+// Usage: verify [--stages STAGE_FILE] [--windows N] [--horizon H] [--seed S]
+#include "Types.hpp"
+#include "Astar.hpp"
+#include "Simulation.hpp"
+#include "StageGenerator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Failures printed per check, the rest are only counted
+constexpr std::uint64_t MAX_PRINTED = 10;
+
+// Comparisons of one kind, over all stages
+struct Tally {
+    const char* name;
+    std::uint64_t compared = 0;
+    std::uint64_t failed = 0;
+};
+
+struct Tallies {
+    Tally guards{"guard monster walks"};
+    Tally dispensers{"dispenser shots"};
+    Tally arrows{"arrow flights"};
+    Tally arrowReach{"arrow reach"};
+    Tally traceMonsters{"trace monster steps"};
+    Tally encoding{"state encoding"};
+};
+
+void check(Tally& tally, bool passed, int stageId, int turns, const std::string& what) {
+    tally.compared++;
+    if(passed) return;
+    if(++tally.failed <= MAX_PRINTED) {
+        std::printf("stage %d, %d actions ahead: %s\n", stageId, turns, what.c_str());
+    }
+}
+
+std::string tileText(const sf::Vector2i& tile) {
+    return "(" + std::to_string(tile.x) + ", " + std::to_string(tile.y) + ")";
+}
+
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state(seed * 6364136223846793005ULL + 1442695040888963407ULL) {}
+
+    int next(int bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((state >> 33) % static_cast<std::uint64_t>(bound));
+    }
+
+    // Mostly moves, now and then a wait
+    Action action() {
+        return next(8) == 0 ? Action::None : static_cast<Action>(next(4));
+    }
+
+private:
+    std::uint64_t state;
+};
+
+std::uint64_t handleKey(ProjectileHandle handle) {
+    return static_cast<std::uint64_t>(handle.slot) << 32 | handle.generation;
+}
+
+// Whether the step just played put a new arrow flying in direction on tile
+bool arrowSpawned(const Simulation& simulation, const std::vector<std::uint64_t>& oldHandles,
+    const sf::Vector2i& tile, char direction) {
+    const ProjectilePool& arrows = simulation.getEntities().arrows;
+    for(int i = 0; i < arrows.size(); i++) {
+        if(arrows.getPosition(i) != tile || arrows.getDirection(i) != direction) continue;
+        if(!std::binary_search(oldHandles.begin(), oldHandles.end(), handleKey(arrows.handleAt(i)))) return true;
+    }
+    return false;
+}
+
+// Play up to horizon actions from base and hold every lookup base answers against them
+void checkWindow(const Simulation& base, int horizon, Random& random, Tallies& tallies) {
+    Simulation play = base;
+    const EntityStore& entities = play.getEntities();
+    const PatternedEntities& guardMonsters = entities.guardMonsters;
+    const PatternedEntities& dispensers = entities.dispensers;
+    const int stageId = base.getStageId();
+
+    // Arrows flying at the start, followed by handle as removals reorder the pool
+    std::vector<ProjectileHandle> flying;
+    for(int i = 0; i < entities.arrows.size(); i++) flying.push_back(entities.arrows.handleAt(i));
+
+    // A* search trace monsters have always followed, their steps through the distance field must agree
+    Pathfinder pathfinder;
+    std::vector<sf::Vector2i> traceStarts;
+
+    // Restored from saved states with the arrows in another order
+    Simulation mirror = base;
+    WorldState saved, shuffled, resaved;
+
+    std::vector<std::uint64_t> oldHandles;
+    std::vector<char> steps(dispensers.size());
+    for(int turns = 1; turns <= horizon; turns++) {
+        // Arrows and dispenser steps before this action, to tell which shots it fired
+        oldHandles.clear();
+        for(int i = 0; i < entities.arrows.size(); i++) oldHandles.push_back(handleKey(entities.arrows.handleAt(i)));
+        std::sort(oldHandles.begin(), oldHandles.end());
+        for(int i = 0; i < dispensers.size(); i++) steps[i] = dispensers.hasPattern(i) ? dispensers.currentStep(i) : 0;
+        traceStarts = entities.traceMonsters;
+        // The actors move before the player does
+        const sf::Vector2i playerStart = play.getPlayer().posTile;
+
+        // The actors still take their pass on the action that ends the play
+        TurnResult result = play.step(random.action());
+
+        // A trace monster takes the first step of the A* path to the player, or stays when that tile is taken
+        for(int i = 0; i < static_cast<int>(traceStarts.size()); i++) {
+            const std::vector<sf::Vector2i>& path = pathfinder.findPath(traceStarts[i], playerStart, play.getTileMap());
+            const sf::Vector2i& stepped = entities.traceMonsters[i];
+            bool passed = stepped == traceStarts[i] || (path.size() > 1 && stepped == path[1]);
+            check(tallies.traceMonsters, passed, stageId, turns,
+                "trace monster " + std::to_string(i) + " stepped from " + tileText(traceStarts[i]) + " to " + tileText(stepped)
+                + (path.size() > 1 ? ", the A* path goes to " + tileText(path[1]) : ", there is no A* path"));
+        }
+
+        for(int i = 0; i < guardMonsters.size(); i++) {
+            sf::Vector2i predicted = base.predictGuardMonster(i, turns);
+            check(tallies.guards, predicted == guardMonsters.positions[i], stageId, turns,
+                "guard monster " + std::to_string(i) + " predicted on " + tileText(predicted)
+                + ", stepped to " + tileText(guardMonsters.positions[i]));
+        }
+
+        // A predicted shot may still be stopped by whatever stands on the spawn tile,
+        // but it has to be the pattern's step, and no shot may come where none is predicted
+        const TileGrid& tileMap = play.getTileMap();
+        for(int i = 0; i < dispensers.size(); i++) {
+            char predicted = base.predictDispenserShot(i, turns - 1);
+            int offset = tileMap.directionOffset(steps[i]);
+            bool fired = offset != 0 && arrowSpawned(play, oldHandles,
+                tileMap.position(tileMap.index(dispensers.positions[i]) + offset), steps[i]);
+            bool passed = predicted == 0 ? !fired : predicted == steps[i];
+            check(tallies.dispensers, passed, stageId, turns,
+                "dispenser " + std::to_string(i) + " predicted shot '" + std::string(1, predicted ? predicted : '-')
+                + "', pattern step '" + std::string(1, steps[i] ? steps[i] : '-') + "'" + (fired ? " fired" : " did not fire"));
+        }
+
+        // Arrows that were already flying, on their own and through the tile query
+        bool playerReached = false;
+        for(int i = 0; i < static_cast<int>(flying.size()); i++) {
+            sf::Vector2i predicted;
+            bool predictedAlive = base.predictArrow(i, turns, predicted);
+            int index = entities.arrows.indexOf(flying[i]);
+            bool alive = index != ProjectilePool::NO_INDEX;
+            sf::Vector2i stepped = alive ? entities.arrows.getPosition(index) : sf::Vector2i{};
+            check(tallies.arrows, predictedAlive == alive && (!alive || predicted == stepped), stageId, turns,
+                "arrow " + std::to_string(i) + " predicted " + (predictedAlive ? "on " + tileText(predicted) : "gone")
+                + ", stepped " + (alive ? "to " + tileText(stepped) : "gone"));
+            if(!alive) continue;
+            check(tallies.arrowReach, base.arrowWillReach(stepped, turns), stageId, turns,
+                "arrow " + std::to_string(i) + " on " + tileText(stepped) + " not reported there");
+            if(stepped == play.getPlayer().posTile) playerReached = true;
+        }
+        const sf::Vector2i& playerTile = play.getPlayer().posTile;
+        check(tallies.arrowReach, base.arrowWillReach(playerTile, turns) == playerReached, stageId, turns,
+            "player tile " + tileText(playerTile) + (playerReached ? " reached but not reported" : " reported but not reached"));
+
+        // Equal states have to encode equally whatever order the pool holds the arrows in
+        play.saveState(saved);
+        shuffled = saved;
+        std::reverse(shuffled.entities.begin() + entities.actorCount(), shuffled.entities.end());
+        mirror.restoreState(shuffled);
+        mirror.saveState(resaved);
+        check(tallies.encoding, resaved == saved, stageId, turns,
+            "state with " + std::to_string(entities.arrowCount()) + " arrows encodes differently after a restore");
+
+        if(result != TurnResult::Continue) return;
+    }
+}
+
+void checkStage(const Simulation& stage, int windows, int horizon, Random& random, Tallies& tallies) {
+    Simulation simulation = stage;
+    for(int window = 0; window < windows; window++) {
+        checkWindow(simulation, horizon, random, tallies);
+        // Move the start of the next window on, through deaths and clears
+        int stride = 1 + random.next(8);
+        for(int i = 0; i < stride; i++) {
+            if(simulation.step(random.action()) != TurnResult::Continue) simulation.reset();
+        }
+    }
+}
+
+// Crowded stages of a few sizes, so monsters, arrows and walls run into each other often
+std::vector<StageDefinition> generatedStages(std::uint64_t seed) {
+    std::vector<StageDefinition> definitions;
+    for(int i = 0; i < 4; i++) {
+        GeneratorOptions options;
+        options.stageId = 101 + i;
+        options.column = options.row = 12 + 8 * i;
+        options.wallDensity = 0.1 * i;
+        options.traceMonsters = 1 + i;
+        options.guardMonsters = 4 + 6 * i;
+        options.dispensers = 2 + 3 * i;
+        options.patternLength = 3 + 2 * i;
+        options.seed = seed + i;
+        definitions.push_back(StageGenerator::generate(options));
+    }
+    return definitions;
+}
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s [--stages STAGE_FILE] [--windows N] [--horizon H] [--seed S]\n", program);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string stageFile = "stages.txt";
+    int windows = 200;
+    int horizon = 64;
+    std::uint64_t seed = 1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--stages" && hasValue) {
+            stageFile = argv[++i];
+        } else if(arg == "--windows" && hasValue) {
+            windows = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--horizon" && hasValue) {
+            horizon = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<StageDefinition> definitions;
+    if(!Simulation::loadDefinitions(stageFile, definitions)) {
+        std::fprintf(stderr, "Cannot load %s\n", stageFile.c_str());
+        return 2;
+    }
+    std::vector<StageDefinition> generated = generatedStages(seed);
+    definitions.insert(definitions.end(), generated.begin(), generated.end());
+
+    Random random(seed);
+    Tallies tallies;
+    for(const StageDefinition& definition : definitions) {
+        checkStage(Simulation(definition), windows, horizon, random, tallies);
+    }
+
+    bool passed = true;
+    for(const Tally* tally : {&tallies.guards, &tallies.dispensers, &tallies.arrows, &tallies.arrowReach, &tallies.traceMonsters, &tallies.encoding}) {
+        std::printf("%-24s %12llu compared %8llu mismatched\n", tally->name,
+            static_cast<unsigned long long>(tally->compared), static_cast<unsigned long long>(tally->failed));
+        if(tally->failed > 0) passed = false;
+    }
+    std::printf(passed ? "All lookups agree with stepped play.\n" : "Lookups disagree with stepped play.\n");
+    return passed ? 0 : 1;
+}
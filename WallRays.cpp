@@ -0,0 +1,47 @@
+#include "WallRays.hpp"
+
+WallRays::WallRays(const TileGrid& tileMap) :
+    neighborOffsets(tileMap.getNeighborOffsets()),
+    ranges(tileMap.getCellCount() * TileGrid::NEIGHBOR_COUNT, 0) {
+    const int cellCount = static_cast<int>(tileMap.getCellCount());
+
+    // Each range is one more than the range of the next tile, unless that tile blocks.
+    // Up and Left look at lower indices and are swept forwards, Down and Right backwards.
+    // Border cells keep 0, nothing ever flies from them.
+    for(int slot = 0; slot < TileGrid::NEIGHBOR_COUNT; slot++) {
+        const int offset = neighborOffsets[slot];
+        const bool forwards = offset < 0;
+        for(int n = 0; n < cellCount; n++) {
+            int i = forwards ? n : cellCount - 1 - n;
+            int next = i + offset;
+            if(next < 0 || next >= cellCount || tileMap.hasAny(TileGrid::BLOCKING, next)) continue;
+            ranges[i * TileGrid::NEIGHBOR_COUNT + slot] = ranges[next * TileGrid::NEIGHBOR_COUNT + slot] + 1;
+        }
+    }
+}
+
+int WallRays::directionSlot(char direction) {
+    if(direction == SYMBOL_UP) return 0;
+    if(direction == SYMBOL_DOWN) return 1;
+    if(direction == SYMBOL_LEFT) return 2;
+    if(direction == SYMBOL_RIGHT) return 3;
+    return -1;
+}
+
+int WallRays::range(int index, char direction) const {
+    int slot = directionSlot(direction);
+    if(slot < 0) return 0;
+    return ranges[index * TileGrid::NEIGHBOR_COUNT + slot];
+}
+
+bool WallRays::positionAt(int index, char direction, int turns, int& result) const {
+    int slot = directionSlot(direction);
+    // Anything that is not a direction stops in the first pass
+    if(slot < 0) {
+        result = index;
+        return turns <= 0;
+    }
+    if(turns > ranges[index * TileGrid::NEIGHBOR_COUNT + slot]) return false;
+    result = index + turns * neighborOffsets[slot];
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include "TileGrid.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Free flight distance from every tile in each of the four directions, built once per stage.
+// Arrows only stop at walls, dispensers and the border, none of which ever move,
+// so where an arrow is after any number of turns follows from its start tile and direction alone.
+class WallRays {
+public:
+    WallRays() = default;
+    explicit WallRays(const TileGrid& tileMap);
+
+    // Neighbor slot of a direction symbol (Up, Down, Left, Right as in TileGrid), -1 for anything else
+    static int directionSlot(char direction);
+
+    // Tiles an arrow leaving index in direction can enter before it hits something (0 if the next tile blocks)
+    int range(int index, char direction) const;
+    // Arrow pass in which an arrow on index stops and is removed (1 is the next pass)
+    int stopTurn(int index, char direction) const { return range(index, direction) + 1; }
+    // Cell of an arrow on index after `turns` arrow passes
+    // Returns false if it has been removed by then
+    bool positionAt(int index, char direction, int turns, int& result) const;
+
+private:
+    std::array<int, 4> neighborOffsets = {};
+    // Four ranges per cell, in neighbor order
+    std::vector<std::int32_t> ranges;
+};
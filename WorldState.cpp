@@ -0,0 +1,50 @@
+#include "WorldState.hpp"
+
+namespace {
+    const std::uint64_t SEED = 0x5DEECE66D2545F49ULL;
+
+    // splitmix64 finalizer: turns structured inputs into well-distributed keys
+    std::uint64_t mix(std::uint64_t value) {
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    // Separate key families so e.g. an arrow key never equals a player key
+    enum KeyFamily : std::uint64_t {
+        FAMILY_PLAYER = 2,
+        FAMILY_ENTITY = 3,
+        FAMILY_ARROW = 4,
+    };
+
+    std::uint64_t key(KeyFamily family, std::uint64_t a, std::uint64_t b, std::uint64_t c = 0) {
+        return mix(SEED ^ mix((family << 56) ^ (a << 32) ^ b) ^ mix(c + family));
+    }
+}
+
+bool WorldState::operator==(const WorldState& other) const {
+    if(hash != other.hash || playerX != other.playerX || playerY != other.playerY) return false;
+    if(entities.size() != other.entities.size()) return false;
+    for(size_t i = 0; i < entities.size(); i++) {
+        const EntityState& a = entities[i];
+        const EntityState& b = other.entities[i];
+        if(a.x != b.x || a.y != b.y || a.kind != b.kind || a.direction != b.direction || a.cursor != b.cursor) return false;
+    }
+    return true;
+}
+
+namespace Zobrist {
+    std::uint64_t playerKey(int index) {
+        return key(FAMILY_PLAYER, 0, static_cast<std::uint32_t>(index));
+    }
+
+    std::uint64_t entityKey(int slot, int index, int cursor) {
+        return key(FAMILY_ENTITY, static_cast<std::uint32_t>(slot), static_cast<std::uint32_t>(index),
+            static_cast<std::uint32_t>(cursor));
+    }
+
+    std::uint64_t arrowKey(char direction, int index) {
+        return key(FAMILY_ARROW, static_cast<unsigned char>(direction), static_cast<std::uint32_t>(index));
+    }
+}
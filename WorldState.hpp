@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact, canonical encoding of everything that changes while a stage is played.
+// Static tiles (walls, goals, dispensers) are not stored: they come from the stage itself,
+// and which tiles hold monsters or arrows follows from the entities.
+
+// One dynamic object (monster, dispenser or arrow), 8 bytes
+struct EntityState {
+    std::int16_t x;
+    std::int16_t y;
+    // Object symbol (SYMBOL_TRACE_MONSTER, SYMBOL_ARROW, ...)
+    char kind;
+    // Flight direction for arrows, 0 otherwise
+    char direction;
+    // Index of the next pattern step for guard monsters and dispensers
+    std::uint16_t cursor;
+};
+static_assert(sizeof(EntityState) == 8, "EntityState must stay packed");
+
+struct WorldState {
+    std::uint64_t hash = 0;
+    std::int16_t playerX = 0;
+    std::int16_t playerY = 0;
+    // Monsters and dispensers in stage order, followed by arrows sorted by tile (row-major) and direction
+    std::vector<EntityState> entities;
+
+    bool operator==(const WorldState& other) const;
+};
+
+// Zobrist keys for incremental 64-bit state hashing.
+// Keys are derived from their inputs with a fixed-seed mixer instead of stored tables,
+// so they work for any stage size without allocating.
+namespace Zobrist {
+    // Player standing on a tile
+    std::uint64_t playerKey(int index);
+    // Monster or dispenser number `slot` on a tile with its pattern cursor
+    std::uint64_t entityKey(int slot, int index, int cursor);
+    // Arrow flying in `direction` on a tile
+    std::uint64_t arrowKey(char direction, int index);
+}
@@ -11,6 +11,11 @@ echo Compiling Constants.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Constants.cpp -o Constants.o
 if errorlevel 1 goto error
 
+REM 編譯 Config.cpp (輸出 Config.o)
+echo Compiling Config.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c Config.cpp -o Config.o
+if errorlevel 1 goto error
+
 REM 編譯 Logger.cpp (輸出 Logger.o)
 echo Compiling Logger.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Logger.cpp -o Logger.o
@@ -21,21 +26,101 @@ echo Compiling Utils.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Utils.cpp -o Utils.o
 if errorlevel 1 goto error
 
+REM 編譯 Pattern.cpp (輸出 Pattern.o)
+echo Compiling Pattern.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c Pattern.cpp -o Pattern.o
+if errorlevel 1 goto error
+
 REM 編譯 Shape.cpp (輸出 Shape.o)
 echo Compiling Shape.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Shape.cpp -o Shape.o
 if errorlevel 1 goto error
 
+REM 編譯 TileGrid.cpp (輸出 TileGrid.o)
+echo Compiling TileGrid.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c TileGrid.cpp -o TileGrid.o
+if errorlevel 1 goto error
+
+REM 編譯 RenderScheduler.cpp (輸出 RenderScheduler.o)
+echo Compiling RenderScheduler.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c RenderScheduler.cpp -o RenderScheduler.o
+if errorlevel 1 goto error
+
+REM 編譯 Profiler.cpp (輸出 Profiler.o)
+echo Compiling Profiler.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c Profiler.cpp -o Profiler.o
+if errorlevel 1 goto error
+
+REM 編譯 ProfilerOverlay.cpp (輸出 ProfilerOverlay.o)
+echo Compiling ProfilerOverlay.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c ProfilerOverlay.cpp -o ProfilerOverlay.o
+if errorlevel 1 goto error
+
 REM 編譯 Astar.cpp (輸出 Astar.o)
 echo Compiling Astar.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Astar.cpp -o Astar.o
 if errorlevel 1 goto error
 
+REM 編譯 DistanceField.cpp (輸出 DistanceField.o)
+echo Compiling DistanceField.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c DistanceField.cpp -o DistanceField.o
+if errorlevel 1 goto error
+
 REM 編譯 Object.cpp (輸出 Object.o)
 echo Compiling Object.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Object.cpp -o Object.o
 if errorlevel 1 goto error
 
+REM 編譯 ProjectilePool.cpp (輸出 ProjectilePool.o)
+echo Compiling ProjectilePool.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c ProjectilePool.cpp -o ProjectilePool.o
+if errorlevel 1 goto error
+
+REM 編譯 WallRays.cpp (輸出 WallRays.o)
+echo Compiling WallRays.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c WallRays.cpp -o WallRays.o
+if errorlevel 1 goto error
+
+REM 編譯 EntityStore.cpp (輸出 EntityStore.o)
+echo Compiling EntityStore.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c EntityStore.cpp -o EntityStore.o
+if errorlevel 1 goto error
+
+REM 編譯 TrajectoryTable.cpp (輸出 TrajectoryTable.o)
+echo Compiling TrajectoryTable.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c TrajectoryTable.cpp -o TrajectoryTable.o
+if errorlevel 1 goto error
+
+REM 編譯 WorldState.cpp (輸出 WorldState.o)
+echo Compiling WorldState.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c WorldState.cpp -o WorldState.o
+if errorlevel 1 goto error
+
+REM 編譯 MappedFile.cpp (輸出 MappedFile.o)
+echo Compiling MappedFile.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c MappedFile.cpp -o MappedFile.o
+if errorlevel 1 goto error
+
+REM 編譯 StageParser.cpp (輸出 StageParser.o)
+echo Compiling StageParser.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c StageParser.cpp -o StageParser.o
+if errorlevel 1 goto error
+
+REM 編譯 Simulation.cpp (輸出 Simulation.o)
+echo Compiling Simulation.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c Simulation.cpp -o Simulation.o
+if errorlevel 1 goto error
+
+REM 編譯 StateHistory.cpp (輸出 StateHistory.o)
+echo Compiling StateHistory.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c StateHistory.cpp -o StateHistory.o
+if errorlevel 1 goto error
+
+REM 編譯 Replay.cpp (輸出 Replay.o)
+echo Compiling Replay.cpp...
+g++ -std=c++17 -IC:\SFML-3.0.2\include -c Replay.cpp -o Replay.o
+if errorlevel 1 goto error
+
 REM 編譯 Stage.cpp (輸出 Stage.o)
 echo Compiling Stage.cpp...
 g++ -std=c++17 -IC:\SFML-3.0.2\include -c Stage.cpp -o Stage.o
@@ -43,17 +128,34 @@ if errorlevel 1 goto error
 
 REM 連結所有物件檔 (.o) - 輸出 game.exe
 echo Linking game.exe...
-g++ -LC:\SFML-3.0.2\lib .\Constants.o .\Logger.o .\Utils.o .\Shape.o .\Astar.o .\Object.o .\Stage.o .\main.o -o game.exe -lmingw32 -lsfml-graphics -lsfml-window -lsfml-audio -lsfml-system -mwindows
+g++ -LC:\SFML-3.0.2\lib .\Constants.o .\Config.o .\Logger.o .\Utils.o .\Pattern.o .\Shape.o .\TileGrid.o .\RenderScheduler.o .\Profiler.o .\ProfilerOverlay.o .\Astar.o .\DistanceField.o .\Object.o .\ProjectilePool.o .\WallRays.o .\EntityStore.o .\TrajectoryTable.o .\WorldState.o .\MappedFile.o .\StageParser.o .\Simulation.o .\StateHistory.o .\Replay.o .\Stage.o .\main.o -o game.exe -lmingw32 -lsfml-graphics -lsfml-window -lsfml-audio -lsfml-system -mwindows
 if errorlevel 1 goto error
 
 REM 清理物件檔 (可選，但在開發階段很有用)
 del .\main.o
 del .\Constants.o
+del .\Config.o
 del .\Logger.o
 del .\Utils.o
+del .\Pattern.o
 del .\Shape.o
+del .\TileGrid.o
+del .\RenderScheduler.o
+del .\Profiler.o
+del .\ProfilerOverlay.o
 del .\Astar.o
+del .\DistanceField.o
 del .\Object.o
+del .\ProjectilePool.o
+del .\WallRays.o
+del .\EntityStore.o
+del .\TrajectoryTable.o
+del .\WorldState.o
+del .\MappedFile.o
+del .\StageParser.o
+del .\Simulation.o
+del .\StateHistory.o
+del .\Replay.o
 del .\Stage.o
 
 REM 執行 (Execute)
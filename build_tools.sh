@@ -0,0 +1,29 @@
+#!/bin/sh
+# --- Headless tools (Linux) ---
+# The simulation only needs SFML's header-only Vector2, so no SFML libraries are linked.
+# Set SFML_INCLUDE if the SFML headers are not installed system-wide.
+# Debug logging and the frame profiler are compiled out of the tools (LOG_MIN_LEVEL=1, PROFILING=0).
+set -e
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=c++17 -O2 -pthread -DLOG_MIN_LEVEL=1 -DPROFILING=0 ${SFML_INCLUDE:+-I$SFML_INCLUDE}"
+
+# Game logic shared by every tool
+CORE="Config.cpp Logger.cpp Pattern.cpp TileGrid.cpp Astar.cpp DistanceField.cpp Object.cpp ProjectilePool.cpp WallRays.cpp EntityStore.cpp TrajectoryTable.cpp WorldState.cpp MappedFile.cpp StageParser.cpp StageGenerator.cpp Simulation.cpp StateHistory.cpp Replay.cpp"
+
+echo "Building solver..."
+$CXX $CXXFLAGS $CORE StateSet.cpp FrontierStore.cpp Solver.cpp -o solver
+
+echo "Building bench..."
+$CXX $CXXFLAGS $CORE AllocationTracker.cpp Bench.cpp -o bench
+
+echo "Building stresstest..."
+$CXX $CXXFLAGS $CORE AllocationTracker.cpp StressTest.cpp -o stresstest
+
+echo "Building replay..."
+$CXX $CXXFLAGS $CORE ReplayTool.cpp -o replay
+
+echo "Building verify..."
+$CXX $CXXFLAGS $CORE Verify.cpp -o verify
+
+echo "Done."
@@ -6,6 +6,9 @@
 #include "Shape.hpp"
 #include "Object.hpp"
 #include "Stage.hpp"
+#include "RenderScheduler.hpp"
+#include "Profiler.hpp"
+#include "ProfilerOverlay.hpp"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -15,13 +18,14 @@ int main() {
 
     // Initialize logger and resources
     Logger::init("debug_log.txt");
-    Logger::log("Game started.");
+    LOG_INFO("Game started.");
+    Config::init();
     Resource::init();
 
 
 
     // Create the main window
-    sf::RenderWindow window(sf::VideoMode({WORLD_WIDTH, WORLD_HEIGHT}), GAME_TITLE);
+    sf::RenderWindow window(sf::VideoMode({static_cast<unsigned int>(Config::WORLD_WIDTH), static_cast<unsigned int>(Config::WORLD_HEIGHT)}), GAME_TITLE);
     // Set icon (convert sf::Image to icon format)
     const sf::Image& iconImg = Resource::getIcon();
     if(iconImg.getSize().x > 0) {
@@ -29,22 +33,22 @@ int main() {
     }
     // Set a framerate limit (not depending on device refresh rate)
     // setFramerateLimit and setVerticalSyncEnabled should not be used together
-    window.setFramerateLimit(FRAME_RATE);
+    window.setFramerateLimit(Config::FRAME_RATE);
     // window.setVerticalSyncEnabled(true);
 
 
 
     // View setup (used to control what is shown in the window)
     sf::View view;
-    view.setCenter({WORLD_WIDTH / 2.f, WORLD_HEIGHT / 2.f});
-    view.setSize({WORLD_WIDTH, WORLD_HEIGHT});
+    view.setCenter({Config::WORLD_WIDTH / 2.f, Config::WORLD_HEIGHT / 2.f});
+    view.setSize({static_cast<float>(Config::WORLD_WIDTH), static_cast<float>(Config::WORLD_HEIGHT)});
     window.setView(view);
 
 
 
     // Title image
     sf::Sprite titleSprite(Resource::getTitleTexture());
-    titleSprite.setPosition({(WORLD_WIDTH - Resource::getTitleTexture().getSize().x) / 2.f, -50.f}); // 水平置中，Y 軸 150 單位下移
+    titleSprite.setPosition({(Config::WORLD_WIDTH - Resource::getTitleTexture().getSize().x) / 2.f, -50.f}); // 水平置中，Y 軸 150 單位下移
     titleSprite.setColor(sf::Color(255, 255, 255, 180)); // 微透明效果
     
     // Background image
@@ -84,8 +88,8 @@ int main() {
     // Calculate grid dimensions
     float gridWidth = 5 * buttonWidth + 4 * spacing;
     float gridHeight = 2 * buttonHeight + 1 * spacing;
-    float startX = (WORLD_WIDTH - gridWidth) / 2.f;
-    float startY = (WORLD_HEIGHT - gridHeight) / 2.f;
+    float startX = (Config::WORLD_WIDTH - gridWidth) / 2.f;
+    float startY = (Config::WORLD_HEIGHT - gridHeight) / 2.f;
     
     for(int i = 0; i < 10; i++) {
         int row = i / 5;
@@ -110,36 +114,56 @@ int main() {
 
 
     // Store all stages
-    std::vector<Stage> stages;
+    StageLibrary stages;
     Stage::createFromFile(stages);
 
     // Used for dragging view
     bool isDragging = false;
     sf::Vector2i lastMousePos;
 
+    // Only redraw when something changed, otherwise sleep until the next event
+    RenderScheduler scheduler;
+
+    // Phase timings, F3 shows them and F4 starts / stops a trace capture
+    ProfilerOverlay profilerOverlay(Resource::getButtonFont());
+    const std::string PROFILE_TRACE_FILE = "profile_trace.json";
+    const std::string LAST_REPLAY_FILE = "last_replay.slr";
+
 
 
     // Start the game loop
     while(window.isOpen()) {
 
         // I: Process events
-        while(const std::optional event = window.pollEvent()) {
+        // Blocks while the scene is clean, then drains every pending event
+        std::optional event = scheduler.waitForEvent(window);
+        // Sleeping in waitEvent is idle time, the frame starts once there is something to do
+        ProfileTimer frameTimer(ProfilePhase::Frame);
+        ProfileTimer eventTimer(ProfilePhase::Events);
+        for(; event; event = window.pollEvent()) {
+            // Every input except plain mouse movement may change what is on screen
+            if(!event->is<sf::Event::MouseMoved>() || isDragging) {
+                scheduler.invalidate();
+            }
+
             if(event->is<sf::Event::Closed>()) {
                 Resource::getMusic().stop();
                 window.close();
-                Logger::log("Window closed by user.");
+                LOG_INFO("Window closed by user.");
             } 
             
             else if (const auto* resized = event->getIf<sf::Event::Resized>()) {
                 // Keep view fixed to world size to prevent stretching ...?
                 // The viewport will add black bars as needed
-                window.setView(sf::View(sf::FloatRect({0.f, 0.f}, {WORLD_WIDTH, WORLD_HEIGHT})));
-                Logger::log("Window resized to " + std::to_string(resized->size.x) + "x" + std::to_string(resized->size.y) + ".");
+                window.setView(sf::View(sf::FloatRect({0.f, 0.f}, {static_cast<float>(Config::WORLD_WIDTH), static_cast<float>(Config::WORLD_HEIGHT)})));
+                // The cached stage layers were baked for the old window size
+                stages.invalidateStaticLayers();
+                LOG_INFO("Window resized to " + std::to_string(resized->size.x) + "x" + std::to_string(resized->size.y) + ".");
             } 
             
             else if(const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>()) {
                 if(mousePressed->button == sf::Mouse::Button::Left) {
-                    Logger::log("Clicked left button at (" + std::to_string(mousePressed->position.x) + ", " 
+                    LOG_INFO("Clicked left button at (" + std::to_string(mousePressed->position.x) + ", " 
                         + std::to_string(mousePressed->position.y) + ").");
 
                     if(gameState == GameState::TitleScreen) {
@@ -149,13 +173,13 @@ int main() {
                         // Check if start button is pressed
                         if(startButton.isClicked(worldPos)) {
                             gameState = GameState::StageSelect;
-                            Logger::log("Start Game button pressed. Entering Stage Select state.");
+                            LOG_INFO("Start Game button pressed. Entering Stage Select state.");
                         } else if(settingsButton.isClicked(worldPos)) {
-                            Logger::log("Settings button pressed. (No action implemented)");
+                            LOG_INFO("Settings button pressed. (No action implemented)");
                         } else if(quitButton.isClicked(worldPos)) {
                             Resource::getMusic().stop();
                             window.close();
-                            Logger::log("Quit button pressed. Exiting game.");
+                            LOG_INFO("Quit button pressed. Exiting game.");
                         }
                     }
 
@@ -167,13 +191,13 @@ int main() {
                         for(int i = 0; i < stageButtons.size(); i++) {
                             if(stageButtons[i].isClicked(worldPos)) {
                                 if(i >= stages.size()) {
-                                    Logger::log("Stage " + std::to_string(i + 1) + " does not exist. Staying in Stage Select.");
+                                    LOG_INFO("Stage " + std::to_string(i + 1) + " does not exist. Staying in Stage Select.");
                                     break;
                                 }
 
                                 gameState = GameState::Playing;
                                 stageIndex = i + 1;
-                                Logger::log("Stage " + std::to_string(stageIndex) + " button pressed. Entering Playing state.");
+                                LOG_INFO("Stage " + std::to_string(stageIndex) + " button pressed. Entering Playing state.");
                                 break;
                             }
                         }
@@ -188,19 +212,19 @@ int main() {
                         sf::Vector2f worldPos = window.mapPixelToCoords(mousePressed->position);
 
                         if(Stage::buttonSelect.isClicked(worldPos)) {
-                            Logger::log("SELECT button pressed. Returning to Stage Select.");
+                            LOG_INFO("SELECT button pressed. Returning to Stage Select.");
                             stages.at(stageIndex - 1).reset();
                             gameState = GameState::StageSelect;
                         } else if(Stage::buttonRetry.isClicked(worldPos)) {
-                            Logger::log("RETRY button pressed. Restarting Stage " + std::to_string(stageIndex) + ".");
+                            LOG_INFO("RETRY button pressed. Restarting Stage " + std::to_string(stageIndex) + ".");
                             stages.at(stageIndex - 1).reset();
                             gameState = GameState::Playing;
                         } else if(Stage::buttonNext.isClicked(worldPos)) {
                             if(stageIndex + 1 > stages.size()) {
-                                Logger::log("NEXT button pressed but no more stages. Staying on the screen.");
+                                LOG_INFO("NEXT button pressed but no more stages. Staying on the screen.");
                                 break;
                             } else {
-                                Logger::log("NEXT button pressed. Proceeding to Stage " + std::to_string(stageIndex + 1) + ".");
+                                LOG_INFO("NEXT button pressed. Proceeding to Stage " + std::to_string(stageIndex + 1) + ".");
                                 stages.at(stageIndex - 1).reset();
                                 stageIndex++;
                             }
@@ -236,27 +260,44 @@ int main() {
 
             else if(const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
                 if(keyPressed->code == sf::Keyboard::Key::Escape) {
-                    Logger::log("Escape key pressed.");
+                    LOG_INFO("Escape key pressed.");
 
                     if(gameState == GameState::Playing) {
-                        Logger::log("Returning to Stage Select.");
+                        LOG_INFO("Returning to Stage Select.");
                         gameState = GameState::StageSelect;
                     } else if(gameState == GameState::StageSelect) {
-                        Logger::log("Returning to Title Screen from Stage Select.");
+                        LOG_INFO("Returning to Title Screen from Stage Select.");
                         gameState = GameState::TitleScreen;
                     } else if(gameState == GameState::StageClear) {
                         stages.at(stageIndex - 1).reset();
-                        Logger::log("Returning to Stage Select from Stage Clear.");
+                        LOG_INFO("Returning to Stage Select from Stage Clear.");
                         gameState = GameState::StageSelect;
                     }
                 }
 
+                // Profiler overlay and trace capture work on every screen
+                if(keyPressed->code == sf::Keyboard::Key::F3) {
+                    profilerOverlay.toggle();
+                } else if(keyPressed->code == sf::Keyboard::Key::F4) {
+                    if(Profiler::isCapturing()) Profiler::endCapture(PROFILE_TRACE_FILE);
+                    else Profiler::beginCapture();
+                }
+
                 if(stages.empty()) continue;
                 Stage& currentStage = stages.at(stageIndex - 1);
 
+                // Press F5 to save a replay of everything done on this stage
+                if(keyPressed->code == sf::Keyboard::Key::F5) {
+                    LOG_INFO("F5 key pressed.");
+
+                    if(gameState == GameState::Playing || gameState == GameState::StageClear) {
+                        currentStage.getRecorder().getReplay().save("replay_stage" + std::to_string(stageIndex) + ".slr");
+                    }
+                }
+
                 // Press R to reset stage
                 if(keyPressed->code == sf::Keyboard::Key::R) {
-                    Logger::log("R key pressed.");
+                    LOG_INFO("R key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.reset();
@@ -264,7 +305,7 @@ int main() {
                 }
 
                 if(keyPressed->code == sf::Keyboard::Key::W || keyPressed->code == sf::Keyboard::Key::Up) {
-                    Logger::log("W key pressed.");
+                    LOG_INFO("W key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.addAction(Action::MoveUp);
@@ -272,7 +313,7 @@ int main() {
                 }
 
                 else if(keyPressed->code == sf::Keyboard::Key::A || keyPressed->code == sf::Keyboard::Key::Left) {
-                    Logger::log("A key pressed.");
+                    LOG_INFO("A key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.addAction(Action::MoveLeft);
@@ -280,18 +321,18 @@ int main() {
                 }
 
                 else if(keyPressed->code == sf::Keyboard::Key::S || keyPressed->code == sf::Keyboard::Key::Down) {
-                    Logger::log("S key pressed.");
+                    LOG_INFO("S key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.addAction(Action::MoveDown);
                     } else if(gameState == GameState::TitleScreen) {
                         gameState = GameState::StageSelect;
-                        Logger::log("Start Game button pressed. Entering Stage Select state.");
+                        LOG_INFO("Start Game button pressed. Entering Stage Select state.");
                     }
                 }
 
                 else if(keyPressed->code == sf::Keyboard::Key::D || keyPressed->code == sf::Keyboard::Key::Right) {
-                    Logger::log("D key pressed.");
+                    LOG_INFO("D key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.addAction(Action::MoveRight);
@@ -299,15 +340,24 @@ int main() {
                 }
 
                 else if(keyPressed->code == sf::Keyboard::Key::X) {
-                    Logger::log("X key pressed.");
+                    LOG_INFO("X key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.addAction(Action::None);
                     }
                 }
 
+                else if(keyPressed->code == sf::Keyboard::Key::Z) {
+                    LOG_INFO("Z key pressed.");
+
+                    // Take back the last played turn
+                    if(gameState == GameState::Playing) {
+                        currentStage.rewind(1);
+                    }
+                }
+
                 else if(keyPressed->code == sf::Keyboard::Key::Backspace) {
-                    Logger::log("Backspace key pressed.");
+                    LOG_INFO("Backspace key pressed.");
 
                     if(gameState == GameState::Playing) {
                         currentStage.undoLastAction();
@@ -315,6 +365,7 @@ int main() {
                 }
             }
         }
+        eventTimer.stop();
 
 
 
@@ -325,13 +376,27 @@ int main() {
             if(stages.empty()) continue;
             Stage& currentStage = stages.at(stageIndex - 1);
             if(currentStage.reachMaxActions()) {
+                PROFILE_SCOPE(ProfilePhase::Advance);
                 currentStage.advance(gameState);
+                scheduler.invalidate();
             }
         }
         
 
 
         // III: Update
+        // The overlay shows live numbers, so it keeps the frames coming while it is open
+        if(profilerOverlay.isVisible()) scheduler.invalidate();
+
+        // Nothing changed since the last frame, keep it on screen
+        if(!scheduler.needsRedraw()) {
+            scheduler.frameSkipped();
+            frameTimer.cancel();
+            continue;
+        }
+
+        ProfileTimer drawTimer(ProfilePhase::Draw);
+
         // Clear screen
         window.clear();
 
@@ -364,14 +429,28 @@ int main() {
             stages.at(stageIndex - 1).draw(window, gameState);
         }
 
+        profilerOverlay.draw(window);
+        drawTimer.stop();
+
         // Update the window
-        window.display();
+        {
+            PROFILE_SCOPE(ProfilePhase::Display);
+            window.display();
+        }
+        scheduler.frameDrawn();
     }
 
 
 
     // Cleanup and exit
-    Logger::log("Game exited.");
+    // The stage being played when the game closed is kept, so a problem can be sent in and replayed
+    if(!stages.empty() && (gameState == GameState::Playing || gameState == GameState::StageClear)) {
+        stages.at(stageIndex - 1).getRecorder().getReplay().save(LAST_REPLAY_FILE);
+    }
+    scheduler.reportTotals();
+    if(Profiler::isCapturing()) Profiler::endCapture(PROFILE_TRACE_FILE);
+    Profiler::reportTotals();
+    LOG_INFO("Game exited.");
     Logger::shutdown();
 
     return 0;